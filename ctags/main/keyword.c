@@ -26,50 +26,64 @@
 typedef struct sHashEntry {
 	struct sHashEntry *next;
 	const char *string;
-	langType language;
+	unsigned int hash;
 	int value;
 } hashEntry;
 
+/*  The keywords of a single language. The number of buckets is a power of two
+ *  and is doubled whenever there are more keywords than buckets, so the chains
+ *  stay short no matter how many keywords a language has.
+ */
+typedef struct sKeywordTable {
+	hashEntry **buckets;
+	unsigned int size;
+	unsigned int count;
+} keywordTable;
+
 /*
 *   DATA DEFINITIONS
 */
-static const unsigned int TableSize = 2039;  /* prime */
-static hashEntry **HashTable = NULL;
+static const unsigned int InitialTableSize = 64;
+static keywordTable *KeywordTables = NULL;  /* indexed by language */
+static unsigned int KeywordTableCount = 0;
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static hashEntry **getHashTable (void)
+static keywordTable *getKeywordTable (langType language, bool create)
 {
-	static bool allocated = false;
-
-	if (! allocated)
+	/* also catches LANG_IGNORE and other negative languages */
+	if ((unsigned int) language >= KeywordTableCount)
 	{
 		unsigned int i;
 
-		HashTable = xMalloc (TableSize, hashEntry*);
+		if (! create)
+			return NULL;
 
-		for (i = 0  ;  i < TableSize  ;  ++i)
-			HashTable [i] = NULL;
+		Assert (language >= 0);
 
-		allocated = true;
+		KeywordTables = xRealloc (KeywordTables, language + 1, keywordTable);
+		for (i = KeywordTableCount  ;  i <= (unsigned int) language  ;  ++i)
+		{
+			KeywordTables [i].buckets = NULL;
+			KeywordTables [i].size = 0;
+			KeywordTables [i].count = 0;
+		}
+		KeywordTableCount = language + 1;
 	}
-	return HashTable;
-}
-
-static hashEntry *getHashTableEntry (unsigned long hashedValue)
-{
-	hashEntry **const table = getHashTable ();
-	hashEntry *entry;
-
-	Assert (hashedValue < TableSize);
-	entry = table [hashedValue];
+	if (KeywordTables [language].buckets == NULL)
+	{
+		if (! create)
+			return NULL;
 
-	return entry;
+		KeywordTables [language].size = InitialTableSize;
+		KeywordTables [language].buckets = xCalloc (InitialTableSize, hashEntry*);
+	}
+	return &KeywordTables [language];
 }
 
-static unsigned int hashValue (const char *const string, langType language)
+static unsigned int hashValue (const char *const string)
 {
 	const signed char *p;
 	unsigned int h = 5381;
@@ -80,23 +94,32 @@ static unsigned int hashValue (const char *const string, langType language)
 	for (p = (const signed char *)string; *p != '\0'; p++)
 		h = (h << 5) + h + *p;
 
-	/* consider language as an extra "character" and add it to the hash */
-	h = (h << 5) + h + language;
-
 	return h;
 }
 
-static hashEntry *newEntry (
-		const char *const string, langType language, int value)
+static void growKeywordTable (keywordTable *const table)
 {
-	hashEntry *const entry = xMalloc (1, hashEntry);
+	const unsigned int size = 2 * table->size;
+	hashEntry **const buckets = xCalloc (size, hashEntry*);
+	unsigned int i;
+
+	for (i = 0  ;  i < table->size  ;  ++i)
+	{
+		hashEntry *entry = table->buckets [i];
 
-	entry->next     = NULL;
-	entry->string   = string;
-	entry->language = language;
-	entry->value    = value;
+		while (entry != NULL)
+		{
+			hashEntry *next = entry->next;
+			const unsigned int index = entry->hash & (size - 1);
 
-	return entry;
+			entry->next = buckets [index];
+			buckets [index] = entry;
+			entry = next;
+		}
+	}
+	eFree (table->buckets);
+	table->buckets = buckets;
+	table->size = size;
 }
 
 /*  Note that it is assumed that a "value" of zero means an undefined keyword
@@ -106,63 +129,63 @@ static hashEntry *newEntry (
  */
 extern void addKeyword (const char *const string, langType language, int value)
 {
-	const unsigned int index = hashValue (string, language) % TableSize;
-	hashEntry *entry = getHashTableEntry (index);
+	keywordTable *const table = getKeywordTable (language, true);
+	const unsigned int hash = hashValue (string);
+	hashEntry *entry;
+	unsigned int index;
 
-	if (entry == NULL)
-	{
-		hashEntry **const table = getHashTable ();
-		table [index] = newEntry (string, language, value);
-	}
-	else
+	for (entry = table->buckets [hash & (table->size - 1)]  ;
+		 entry != NULL  ;  entry = entry->next)
 	{
-		hashEntry *prev = NULL;
-
-		while (entry != NULL)
+		if (entry->hash == hash  &&  strcmp (string, entry->string) == 0)
 		{
-			if (language == entry->language  &&
-				strcmp (string, entry->string) == 0)
-			{
-				Assert (("Already in table" == NULL));
-			}
-			prev = entry;
-			entry = entry->next;
-		}
-		if (entry == NULL)
-		{
-			Assert (prev != NULL);
-			prev->next = newEntry (string, language, value);
+			Assert (("Already in table" == NULL));
 		}
 	}
+
+	if (table->count >= table->size)
+		growKeywordTable (table);
+
+	index = hash & (table->size - 1);
+	entry = xMalloc (1, hashEntry);
+	entry->string = string;
+	entry->hash   = hash;
+	entry->value  = value;
+	entry->next   = table->buckets [index];
+	table->buckets [index] = entry;
+	++table->count;
 }
 
 extern int lookupKeyword (const char *const string, langType language)
 {
-	const unsigned int index = hashValue (string, language) % TableSize;
-	hashEntry *entry = getHashTableEntry (index);
-	int result = -1;
+	const keywordTable *const table = getKeywordTable (language, false);
+	unsigned int hash;
+	hashEntry *entry;
 
-	while (entry != NULL)
+	if (table == NULL)
+		return -1;
+
+	hash = hashValue (string);
+	for (entry = table->buckets [hash & (table->size - 1)]  ;
+		 entry != NULL  ;  entry = entry->next)
 	{
-		if (language == entry->language  &&  strcmp (string, entry->string) == 0)
-		{
-			result = entry->value;
-			break;
-		}
-		entry = entry->next;
+		if (entry->hash == hash  &&  strcmp (string, entry->string) == 0)
+			return entry->value;
 	}
-	return result;
+	return -1;
 }
 
 extern void freeKeywordTable (void)
 {
-	if (HashTable != NULL)
+	unsigned int i, j;
+
+	for (i = 0  ;  i < KeywordTableCount  ;  ++i)
 	{
-		unsigned int i;
+		keywordTable *const table = &KeywordTables [i];
 
-		for (i = 0  ;  i < TableSize  ;  ++i)
+		for (j = 0  ;  j < table->size  ;  ++j)
 		{
-			hashEntry *entry = HashTable [i];
+			hashEntry *entry = table->buckets [j];
 
 			while (entry != NULL)
 			{
@@ -171,21 +194,26 @@ extern void freeKeywordTable (void)
 				entry = next;
 			}
 		}
-		eFree (HashTable);
+		if (table->buckets != NULL)
+			eFree (table->buckets);
 	}
+	if (KeywordTables != NULL)
+		eFree (KeywordTables);
+	KeywordTables = NULL;
+	KeywordTableCount = 0;
 }
 
 #ifdef DEBUG
 
-static void printEntry (const hashEntry *const entry)
+static void printEntry (const hashEntry *const entry, langType language)
 {
-	printf ("  %-15s %-7s\n", entry->string, getLanguageName (entry->language));
+	printf ("  %-15s %-7s\n", entry->string, getLanguageName (language));
 }
 
-static unsigned int printBucket (const unsigned int i)
+static unsigned int printBucket (const keywordTable *const table,
+		langType language, const unsigned int i)
 {
-	hashEntry **const table = getHashTable ();
-	hashEntry *entry = table [i];
+	hashEntry *entry = table->buckets [i];
 	unsigned int measure = 1;
 	bool first = true;
 
@@ -201,7 +229,7 @@ static unsigned int printBucket (const unsigned int i)
 			printf (" ");
 			first = false;
 		}
-		printEntry (entry);
+		printEntry (entry, language);
 		entry = entry->next;
 		measure = 2 * measure;
 	}
@@ -212,15 +240,20 @@ extern void printKeywordTable (void)
 {
 	unsigned long emptyBucketCount = 0;
 	unsigned long measure = 0;
-	unsigned int i;
+	unsigned int i, j;
 
-	for (i = 0  ;  i < TableSize  ;  ++i)
+	for (i = 0  ;  i < KeywordTableCount  ;  ++i)
 	{
-		const unsigned int pass = printBucket (i);
+		const keywordTable *const table = &KeywordTables [i];
 
-		measure += pass;
-		if (pass == 0)
-			++emptyBucketCount;
+		for (j = 0  ;  j < table->size  ;  ++j)
+		{
+			const unsigned int pass = printBucket (table, i, j);
+
+			measure += pass;
+			if (pass == 0)
+				++emptyBucketCount;
+		}
 	}
 
 	printf ("spread measure = %ld\n", measure);
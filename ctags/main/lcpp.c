@@ -73,6 +73,7 @@ typedef struct sCppState {
 		unsigned int nestLevel;  /* level 0 is not used */
 		conditionalInfo ifdef [MaxCppNestingLevel];
 	} directive;
+	vString * arglist;       /* stripped text searched for argument lists */
 } cppState;
 
 /*
@@ -95,7 +96,8 @@ static cppState Cpp = {
 		NULL,        /* tag name */
 		0,           /* nestLevel */
 		{ {false,false,false,false} }  /* ifdef array */
-	}  /* directive */
+	},  /* directive */
+	NULL         /* arglist */
 };
 
 /*
@@ -147,6 +149,11 @@ extern void cppTerminate (void)
 		vStringDelete (Cpp.directive.name);
 		Cpp.directive.name = NULL;
 	}
+	if (Cpp.arglist != NULL)
+	{
+		vStringDelete (Cpp.arglist);
+		Cpp.arglist = NULL;
+	}
 }
 
 extern void cppBeginStatement (void)
@@ -852,33 +859,40 @@ typedef enum
 	st_single_quote_t
 } ParseState;
 
-static void stripCodeBuffer(char *buf)
+/* Copies len bytes to dest without comments and string literals and with each
+ * run of whitespace replaced by a single space. The bytes are the head_len bytes
+ * of head followed by the ones of tail, like the segments of
+ * mio_new_memory_segments(). */
+static void stripCodeBuffer(const char *head, size_t head_len, const char *tail,
+							size_t len, vString *dest)
 {
-	int i = 0, pos = 0;
+#define CODE_AT(n) ((n) < head_len ? head[(n)] : tail[(n) - head_len])
+	size_t i;
 	ParseState state = st_none_t, prev_state = st_none_t;
 
-	while (buf[i] != '\0')
+	vStringClear(dest);
+	for (i = 0; i < len && CODE_AT(i) != '\0'; ++i)
 	{
-		switch(buf[i])
+		switch(CODE_AT(i))
 		{
 			case '/':
 				if (st_none_t == state)
 				{
 					/* Check if this is the start of a comment */
-					if (buf[i+1] == '*') /* C comment */
+					if (i + 1 < len && CODE_AT(i+1) == '*') /* C comment */
 						state = st_c_comment_t;
-					else if (buf[i+1] == '/') /* C++ comment */
+					else if (i + 1 < len && CODE_AT(i+1) == '/') /* C++ comment */
 						state = st_cpp_comment_t;
 					else /* Normal character */
-						buf[pos++] = '/';
+						vStringPut(dest, '/');
 				}
 				else if (st_c_comment_t == state)
 				{
 					/* Check if this is the end of a C comment */
-					if (buf[i-1] == '*')
+					if (CODE_AT(i-1) == '*')
 					{
-						if ((pos > 0) && (buf[pos-1] != ' '))
-							buf[pos++] = ' ';
+						if ((vStringLength(dest) > 0) && (vStringLast(dest) != ' '))
+							vStringPut(dest, ' ');
 						state = st_none_t;
 					}
 				}
@@ -896,7 +910,7 @@ static void stripCodeBuffer(char *buf)
 					state = st_none_t;
 				break;
 			default:
-				if ((buf[i] == '\\') && (st_escape_t != state))
+				if ((CODE_AT(i) == '\\') && (st_escape_t != state))
 				{
 					prev_state = state;
 					state = st_escape_t;
@@ -906,38 +920,39 @@ static void stripCodeBuffer(char *buf)
 					state = prev_state;
 					prev_state = st_none_t;
 				}
-				else if ((buf[i] == '\n') && (st_cpp_comment_t == state))
+				else if ((CODE_AT(i) == '\n') && (st_cpp_comment_t == state))
 				{
-					if ((pos > 0) && (buf[pos-1] != ' '))
-						buf[pos++] = ' ';
+					if ((vStringLength(dest) > 0) && (vStringLast(dest) != ' '))
+						vStringPut(dest, ' ');
 					state = st_none_t;
 				}
 				else if (st_none_t == state)
 				{
-					if (isspace(buf[i]))
+					if (isspace((unsigned char) CODE_AT(i)))
 					{
-						if ((pos > 0) && (buf[pos-1] != ' '))
-							buf[pos++] = ' ';
+						if ((vStringLength(dest) > 0) && (vStringLast(dest) != ' '))
+							vStringPut(dest, ' ');
 					}
 					else
-						buf[pos++] = buf[i];
+						vStringPut(dest, CODE_AT(i));
 				}
 				break;
 		}
-		++i;
 	}
-	buf[pos] = '\0';
-	return;
+#undef CODE_AT
 }
 
-static char *getArglistFromStr(char *buf, const char *name)
+static char *getArglistFromStr(const char *head, size_t head_len, const char *tail,
+							   size_t len, const char *name)
 {
 	char *start, *end;
 	int level;
-	if ((NULL == buf) || (NULL == name) || ('\0' == name[0]))
+	if ((NULL == head) || (NULL == name) || ('\0' == name[0]))
 		return NULL;
-	stripCodeBuffer(buf);
-	if (NULL == (start = strstr(buf, name)))
+	if (Cpp.arglist == NULL)
+		Cpp.arglist = vStringNew();
+	stripCodeBuffer(head, head_len, tail, len, Cpp.arglist);
+	if (NULL == (start = strstr(vStringValue(Cpp.arglist), name)))
 		return NULL;
 	if (NULL == (start = strchr(start, '(')))
 		return NULL;
@@ -954,10 +969,15 @@ static char *getArglistFromStr(char *buf, const char *name)
 	return strdup(start);
 }
 
+/* Returns the argument list following tokenName between startPosition and the
+ * current input position. Memory streams, which is how Geany passes all but
+ * huge files and the editor buffers split around their gap, are stripped
+ * directly from the input memory, without reading the text a second time. */
 extern char *cppGetArglistFromFilePos(MIOPos startPosition, const char *tokenName)
 {
 	MIOPos originalPosition;
-	char *result = NULL;
+	unsigned char *head, *tail;
+	size_t head_size, tail_size;
 	char *arglist = NULL;
 	long pos1, pos2;
 
@@ -971,13 +991,21 @@ extern char *cppGetArglistFromFilePos(MIOPos startPosition, const char *tokenNam
 	{
 		size_t len = pos2 - pos1;
 
-		result = (char *) g_malloc(len + 1);
-		if (result != NULL && (len = mio_read(File.mio, result, 1, len)) > 0)
+		head = mio_memory_get_segments(File.mio, &head_size, &tail, &tail_size);
+		if (head != NULL && (size_t) pos1 >= head_size)
+			arglist = getArglistFromStr((const char *) tail + (pos1 - head_size), len,
+				NULL, len, tokenName);
+		else if (head != NULL)
+			arglist = getArglistFromStr((const char *) head + pos1, head_size - pos1,
+				(const char *) tail, len, tokenName);
+		else
 		{
-			result[len] = '\0';
-			arglist = getArglistFromStr(result, tokenName);
+			char *result = (char *) g_malloc(len + 1);
+
+			if ((len = mio_read(File.mio, result, 1, len)) > 0)
+				arglist = getArglistFromStr(result, len, NULL, len, tokenName);
+			g_free(result);
 		}
-		g_free(result);
 	}
 	mio_setpos(File.mio, &originalPosition);
 	return arglist;
@@ -58,6 +58,8 @@ enum pType { PTRN_TAG, PTRN_CALLBACK };
 
 typedef struct {
 	GRegex *pattern;
+	char *literal;  /* text every match contains (lower case if caseless), or NULL */
+	bool caseless;
 	enum pType type;
 	union {
 		struct {
@@ -75,6 +77,9 @@ typedef struct {
 typedef struct {
 	regexPattern *patterns;
 	unsigned int count;
+	unsigned int unfiltered;  /* number of patterns without a literal */
+	bool caseless;            /* whether any literal is caseless */
+	bool firstBytes [256];    /* possible first bytes of the literals */
 } patternSet;
 
 /*
@@ -87,6 +92,9 @@ static bool regexBroken = false;
 static patternSet* Sets = NULL;
 static int SetUpper = -1;  /* upper language index in list */
 
+/* Lower case copy of the line being matched, for caseless literals */
+static vString* LowerLine = NULL;
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -103,6 +111,11 @@ static void clearPatternSet (const langType language)
 			regexPattern *p = &set->patterns [i];
 			g_regex_unref(p->pattern);
 			p->pattern = NULL;
+			if (p->literal != NULL)
+			{
+				eFree (p->literal);
+				p->literal = NULL;
+			}
 
 			if (p->type == PTRN_TAG)
 			{
@@ -121,6 +134,9 @@ static void clearPatternSet (const langType language)
 			eFree (set->patterns);
 		set->patterns = NULL;
 		set->count = 0;
+		set->unfiltered = 0;
+		set->caseless = false;
+		memset (set->firstBytes, 0, sizeof set->firstBytes);
 	}
 }
 
@@ -237,10 +253,145 @@ static bool parseTagRegex (
 	return result;
 }
 
-static void addCompiledTagPattern (
-		const langType language, GRegex* const pattern,
-		char* const name, const char kind, char* const kindName,
-		char *const description)
+/* Skips a bracket expression starting at p, returns the character after it */
+static const char* skipCharacterClass (const char *p)
+{
+	Assert (*p == '[');
+	++p;
+	if (*p == '^')
+		++p;
+	if (*p == ']')
+		++p;
+	while (*p != '\0'  &&  *p != ']')
+	{
+		if (*p == '\\'  &&  p [1] != '\0')
+			p += 2;
+		else if (*p == '['  &&  p [1] == ':'  &&  strstr (p + 2, ":]") != NULL)
+			p = strstr (p + 2, ":]") + 2;
+		else
+			++p;
+	}
+	return (*p == ']') ? p + 1 : p;
+}
+
+/* Finds the longest run of characters every match of regexp must contain, by
+ * looking at unquantified ASCII characters outside of groups and bracket
+ * expressions only. Returns NULL when the pattern has top level alternatives
+ * or constructs this simple scan doesn't understand.
+ */
+static char* extractLiteral (const char* const regexp)
+{
+	/* escapes standing for a single character which is not taken literally */
+	static const char *const singleEscapes = "dDsSwWbBtnrfeaAzZGhHvVRX";
+	vString *const run = vStringNew ();
+	char *best = NULL;
+	size_t bestLength = 0;
+	const char *p = regexp;
+	bool valid = (strstr (regexp, "(?") == NULL);  /* inline options */
+
+	while (valid  &&  *p != '\0')
+	{
+		int literal = -1;
+
+		if (*p == '\\')
+		{
+			if (p [1] == '\0')
+			{
+				valid = false;
+				break;
+			}
+			else if ((unsigned char) p [1] < 0x80  &&  ! g_ascii_isalnum (p [1]))
+				literal = p [1];
+			else if (strchr (singleEscapes, p [1]) == NULL)
+				valid = false;
+			p += 2;
+		}
+		else if (*p == '[')
+			p = skipCharacterClass (p);
+		else if (*p == '(')
+		{
+			int depth = 0;
+			do
+			{
+				if (*p == '\\'  &&  p [1] != '\0')
+					p += 2;
+				else if (*p == '[')
+					p = skipCharacterClass (p);
+				else
+				{
+					if (*p == '(')
+						++depth;
+					else if (*p == ')')
+						--depth;
+					++p;
+				}
+			}
+			while (*p != '\0'  &&  depth > 0);
+		}
+		else if (*p == '|'  ||  *p == ')'  ||  *p == '*'  ||  *p == '+'  ||  *p == '?')
+			valid = false;
+		else if (*p == '.'  ||  *p == '^'  ||  *p == '$'  ||  (unsigned char) *p >= 0x80)
+			++p;
+		else
+			literal = *p++;
+
+		if (! valid)
+			break;
+
+		if (*p == '*'  ||  *p == '?'  ||  (*p == '{'  &&  g_ascii_isdigit (p [1])))
+		{
+			/* the atom is optional */
+			literal = -1;
+			if (*p == '{')
+				while (*p != '\0'  &&  *p != '}')
+					++p;
+			if (*p != '\0')
+				++p;
+		}
+		else if (*p == '+')
+		{
+			/* the atom is required, but may be followed by another copy */
+			if (literal >= 0)
+				vStringPut (run, literal);
+			literal = -1;
+			++p;
+		}
+		else if (literal >= 0)
+		{
+			vStringPut (run, literal);
+			continue;
+		}
+		/* lazy and possessive quantifiers */
+		if (*p == '?'  ||  *p == '+')
+			++p;
+
+		if (vStringLength (run) > bestLength)
+		{
+			if (best != NULL)
+				eFree (best);
+			best = eStrdup (vStringValue (run));
+			bestLength = vStringLength (run);
+		}
+		vStringClear (run);
+	}
+
+	if (valid  &&  vStringLength (run) > bestLength)
+	{
+		if (best != NULL)
+			eFree (best);
+		best = eStrdup (vStringValue (run));
+	}
+	else if (! valid  &&  best != NULL)
+	{
+		eFree (best);
+		best = NULL;
+	}
+	vStringDelete (run);
+	return best;
+}
+
+static regexPattern* newPattern (const langType language, GRegex* const pattern,
+		const char* const regexp)
 {
 	patternSet* set;
 	regexPattern *ptrn;
@@ -252,6 +403,9 @@ static void addCompiledTagPattern (
 		{
 			Sets [i].patterns = NULL;
 			Sets [i].count = 0;
+			Sets [i].unfiltered = 0;
+			Sets [i].caseless = false;
+			memset (Sets [i].firstBytes, 0, sizeof Sets [i].firstBytes);
 		}
 		SetUpper = language;
 	}
@@ -260,7 +414,40 @@ static void addCompiledTagPattern (
 	ptrn = &set->patterns [set->count];
 	set->count += 1;
 
-	ptrn->pattern = pattern;
+	ptrn->pattern  = pattern;
+	ptrn->literal  = extractLiteral (regexp);
+	ptrn->caseless = (g_regex_get_compile_flags (pattern) & G_REGEX_CASELESS) != 0;
+	if (ptrn->literal == NULL)
+		set->unfiltered += 1;
+	else
+	{
+		const unsigned char first = (unsigned char) ptrn->literal [0];
+
+		set->firstBytes [first] = true;
+		if (ptrn->caseless)
+		{
+			unsigned int i;
+
+			for (i = 0; ptrn->literal [i] != '\0'; i++)
+				ptrn->literal [i] = g_ascii_tolower (ptrn->literal [i]);
+			set->firstBytes [(unsigned char) g_ascii_tolower (first)] = true;
+			set->firstBytes [(unsigned char) g_ascii_toupper (first)] = true;
+			/* Unicode case folding maps some non-ASCII characters to ASCII letters */
+			for (i = 0x80; i < 256; i++)
+				set->firstBytes [i] = true;
+			set->caseless = true;
+		}
+	}
+	return ptrn;
+}
+
+static void addCompiledTagPattern (
+		const langType language, GRegex* const pattern, const char* const regexp,
+		char* const name, const char kind, char* const kindName,
+		char *const description)
+{
+	regexPattern *const ptrn = newPattern (language, pattern, regexp);
+
 	ptrn->type    = PTRN_TAG;
 	ptrn->u.tag.name_pattern = name;
 	ptrn->u.tag.kind.enabled = true;
@@ -270,28 +457,11 @@ static void addCompiledTagPattern (
 }
 
 static void addCompiledCallbackPattern (
-		const langType language, GRegex* const pattern,
+		const langType language, GRegex* const pattern, const char* const regexp,
 		const regexCallback callback)
 {
-	patternSet* set;
-	regexPattern *ptrn;
-	if (language > SetUpper)
-	{
-		int i;
-		Sets = xRealloc (Sets, (language + 1), patternSet);
-		for (i = SetUpper + 1  ;  i <= language  ;  ++i)
-		{
-			Sets [i].patterns = NULL;
-			Sets [i].count = 0;
-		}
-		SetUpper = language;
-	}
-	set = Sets + language;
-	set->patterns = xRealloc (set->patterns, (set->count + 1), regexPattern);
-	ptrn = &set->patterns [set->count];
-	set->count += 1;
+	regexPattern *const ptrn = newPattern (language, pattern, regexp);
 
-	ptrn->pattern = pattern;
 	ptrn->type    = PTRN_CALLBACK;
 	ptrn->u.callback.function = callback;
 }
@@ -502,8 +672,32 @@ static bool matchRegexPattern (const vString* const line,
 
 /* PUBLIC INTERFACE */
 
+/* Whether the line contains a byte any literal of the set may start with */
+static bool lineHasFirstByte (const vString* const line, const patternSet* const set)
+{
+	const unsigned char *p;
+
+	for (p = (const unsigned char *) vStringValue (line)  ;  *p != '\0'  ;  ++p)
+		if (set->firstBytes [*p])
+			return true;
+	return false;
+}
+
+/* Whether the line contains the literal of the pattern. lower is the lower
+ * case copy of a pure ASCII line for caseless literals, or NULL. */
+static bool lineHasLiteral (const vString* const line, const vString* const lower,
+		const regexPattern* const ptrn)
+{
+	if (ptrn->literal == NULL)
+		return true;
+	if (ptrn->caseless)
+		return lower == NULL  ||  strstr (vStringValue (lower), ptrn->literal) != NULL;
+	return strstr (vStringValue (line), ptrn->literal) != NULL;
+}
+
 /* Match against all patterns for specified language. Returns true if at least
- * on pattern matched.
+ * on pattern matched. Only the patterns whose literal occurs in the line are
+ * run, and none at all if the line can't contain any of the literals.
  */
 extern bool matchRegex (const vString* const line, const langType language)
 {
@@ -512,9 +706,29 @@ extern bool matchRegex (const vString* const line, const langType language)
 		Sets [language].count > 0)
 	{
 		const patternSet* const set = Sets + language;
+		const vString *lower = NULL;
 		unsigned int i;
+
+		if (set->unfiltered == 0  &&  ! lineHasFirstByte (line, set))
+			return false;
+
+		if (set->caseless)
+		{
+			const char *p;
+
+			if (LowerLine == NULL)
+				LowerLine = vStringNew ();
+			vStringClear (LowerLine);
+			for (p = vStringValue (line)  ;  *p != '\0'  &&  (unsigned char) *p < 0x80  ;  ++p)
+				vStringPut (LowerLine, g_ascii_tolower (*p));
+			/* non-ASCII characters may fold to ASCII ones, don't filter such lines */
+			if (*p == '\0')
+				lower = LowerLine;
+		}
+
 		for (i = 0  ;  i < set->count  ;  ++i)
-			if (matchRegexPattern (line, set->patterns + i))
+			if (lineHasLiteral (line, lower, set->patterns + i)  &&
+				matchRegexPattern (line, set->patterns + i))
 				result = true;
 	}
 	return result;
@@ -548,7 +762,7 @@ extern void addTagRegex (
 			char* kindName;
 			char* description;
 			parseKinds (kinds, &kind, &kindName, &description);
-			addCompiledTagPattern (language, cp, eStrdup (name),
+			addCompiledTagPattern (language, cp, regex, eStrdup (name),
 					kind, kindName, description);
 		}
 	}
@@ -567,7 +781,7 @@ extern void addCallbackRegex (
 	{
 		GRegex* const cp = compileRegex (regex, flags);
 		if (cp != NULL)
-			addCompiledCallbackPattern (language, cp, callback);
+			addCompiledCallbackPattern (language, cp, regex, callback);
 	}
 #endif
 }
@@ -676,6 +890,9 @@ extern void freeRegexResources (void)
 		eFree (Sets);
 	Sets = NULL;
 	SetUpper = -1;
+	if (LowerLine != NULL)
+		vStringDelete (LowerLine);
+	LowerLine = NULL;
 #endif
 }
 
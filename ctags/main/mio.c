@@ -31,6 +31,7 @@
 #define MIO_CHUNK_SIZE 4096
 
 #define MAX(a, b)  (((a) > (b)) ? (a) : (b))
+#define MIN(a, b)  (((a) < (b)) ? (a) : (b))
 
 
 /**
@@ -219,6 +220,8 @@ MIO *mio_new_memory (unsigned char *data,
 	{
 		mio->type = MIO_TYPE_MEMORY;
 		mio->impl.mem.buf = data;
+		mio->impl.mem.tail = NULL;
+		mio->impl.mem.head_size = (size_t) -1;
 		mio->impl.mem.ungetch = EOF;
 		mio->impl.mem.pos = 0;
 		mio->impl.mem.size = size;
@@ -232,6 +235,81 @@ MIO *mio_new_memory (unsigned char *data,
 	return mio;
 }
 
+/**
+ * mio_new_memory_segments:
+ * @head: Initial data
+ * @head_size: Length of @head in bytes
+ * @tail: Data following @head
+ * @tail_size: Length of @tail in bytes
+ *
+ * Creates a new read-only #MIO object working on memory split in two
+ * segments, like the text of an editor buffer around its gap. The stream
+ * reads the bytes of @tail right after the ones of @head. Neither segment
+ * is copied nor freed by the stream.
+ *
+ * Free-function: mio_free()
+ *
+ * Returns: A new #MIO on success, or %NULL on failure.
+ */
+MIO *mio_new_memory_segments (unsigned char *head,
+							  size_t head_size,
+							  unsigned char *tail,
+							  size_t tail_size)
+{
+	MIO *mio;
+
+	if (tail == NULL || tail_size == 0)
+		return mio_new_memory (head, head_size, NULL, NULL);
+
+	mio = mio_new_memory (head, head_size + tail_size, NULL, NULL);
+	if (mio)
+	{
+		mio->impl.mem.tail = tail;
+		mio->impl.mem.head_size = head_size;
+	}
+
+	return mio;
+}
+
+/*
+ * mem_byte:
+ * @mio: A #MIO object of the type %MIO_TYPE_MEMORY
+ * @pos: Offset of the byte, smaller than the size of the stream
+ *
+ * Returns: The byte at offset @pos of the possibly segmented memory.
+ */
+static unsigned char mem_byte (MIO *mio, size_t pos)
+{
+	/* head_size is the largest size_t value for unsegmented memory */
+	if (pos < mio->impl.mem.head_size)
+		return mio->impl.mem.buf[pos];
+	return mio->impl.mem.tail[pos - mio->impl.mem.head_size];
+}
+
+/*
+ * mem_copy:
+ * @mio: A #MIO object of the type %MIO_TYPE_MEMORY
+ * @dest: Memory to copy to
+ * @pos: Offset of the first byte to copy
+ * @n: Number of bytes to copy, at most the size of the stream minus @pos
+ *
+ * Copies bytes of the possibly segmented memory.
+ */
+static void mem_copy (MIO *mio, unsigned char *dest, size_t pos, size_t n)
+{
+	if (pos < mio->impl.mem.head_size)
+	{
+		size_t head_n = MIN (n, mio->impl.mem.head_size - pos);
+
+		memcpy (dest, &mio->impl.mem.buf[pos], head_n);
+		dest += head_n;
+		pos += head_n;
+		n -= head_n;
+	}
+	if (n > 0)
+		memcpy (dest, &mio->impl.mem.tail[pos - mio->impl.mem.head_size], n);
+}
+
 /**
  * mio_file_get_fp:
  * @mio: A #MIO object
@@ -268,13 +346,13 @@ FILE *mio_file_get_fp (MIO *mio)
  * was configured to free the memory when destroyed.</para></warning>
  *
  * Returns: The memory buffer of the given #MIO stream, or %NULL if the stream
- *          is not a memory stream.
+ *          is not a memory stream or its memory is split in segments.
  */
 unsigned char *mio_memory_get_data (MIO *mio, size_t *size)
 {
 	unsigned char *ptr = NULL;
 
-	if (mio->type == MIO_TYPE_MEMORY)
+	if (mio->type == MIO_TYPE_MEMORY && mio->impl.mem.tail == NULL)
 	{
 		ptr = mio->impl.mem.buf;
 		if (size)
@@ -284,6 +362,43 @@ unsigned char *mio_memory_get_data (MIO *mio, size_t *size)
 	return ptr;
 }
 
+/**
+ * mio_memory_get_segments:
+ * @mio: A #MIO object
+ * @head_size: (out): Return location for the length of the returned memory
+ * @tail: (out): Return location for the memory following the returned one,
+ *        %NULL if the memory is not split in segments
+ * @tail_size: (out): Return location for the length of @tail
+ *
+ * Gets the underlying memory of a #MIO memory stream, also when it is split
+ * in segments by mio_new_memory_segments().
+ *
+ * Returns: The memory of the given #MIO stream up to the end of its first
+ *          segment, or %NULL if the stream is not a memory stream.
+ */
+unsigned char *mio_memory_get_segments (MIO *mio,
+										size_t *head_size,
+										unsigned char **tail,
+										size_t *tail_size)
+{
+	if (mio->type != MIO_TYPE_MEMORY)
+		return NULL;
+
+	*tail = mio->impl.mem.tail;
+	if (*tail == NULL)
+	{
+		*head_size = mio->impl.mem.size;
+		*tail_size = 0;
+	}
+	else
+	{
+		*head_size = mio->impl.mem.head_size;
+		*tail_size = mio->impl.mem.size - mio->impl.mem.head_size;
+	}
+
+	return mio->impl.mem.buf;
+}
+
 /**
  * mio_free:
  * @mio: A #MIO object
@@ -310,6 +425,8 @@ int mio_free (MIO *mio)
 			if (mio->impl.mem.free_func)
 				mio->impl.mem.free_func (mio->impl.mem.buf);
 			mio->impl.mem.buf = NULL;
+			mio->impl.mem.tail = NULL;
+			mio->impl.mem.head_size = 0;
 			mio->impl.mem.pos = 0;
 			mio->impl.mem.size = 0;
 			mio->impl.mem.allocated_size = 0;
@@ -373,7 +490,7 @@ size_t mio_read (MIO *mio,
 					ptr++;
 				}
 
-				memcpy (ptr, &mio->impl.mem.buf[mio->impl.mem.pos], copy_bytes);
+				mem_copy (mio, ptr, mio->impl.mem.pos, copy_bytes);
 				mio->impl.mem.pos += copy_bytes;
 			}
 			if (mio->impl.mem.pos >= mio->impl.mem.size)
@@ -465,6 +582,10 @@ static int mem_try_ensure_space (MIO *mio, size_t n)
 {
 	int success = true;
 
+	/* segmented memory is read-only */
+	if (mio->impl.mem.tail != NULL)
+		return false;
+
 	if (mio->impl.mem.pos + n > mio->impl.mem.size)
 		success = mem_try_resize (mio, mio->impl.mem.pos + n);
 
@@ -674,7 +795,7 @@ int mio_getc (MIO *mio)
 		}
 		else if (mio->impl.mem.pos < mio->impl.mem.size)
 		{
-			rv = mio->impl.mem.buf[mio->impl.mem.pos];
+			rv = mem_byte (mio, mio->impl.mem.pos);
 			mio->impl.mem.pos++;
 		}
 		else
@@ -752,7 +873,7 @@ char *mio_gets (MIO *mio, char *s, size_t size)
 			}
 			for (; mio->impl.mem.pos < mio->impl.mem.size && i < (size - 1); i++)
 			{
-				s[i] = (char)mio->impl.mem.buf[mio->impl.mem.pos];
+				s[i] = (char)mem_byte (mio, mio->impl.mem.pos);
 				mio->impl.mem.pos++;
 				if (s[i] == '\n')
 				{
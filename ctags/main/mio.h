@@ -122,6 +122,8 @@ struct _MIO {
 		} file;
 		struct {
 			unsigned char *buf;
+			unsigned char *tail;
+			size_t head_size;
 			int ungetch;
 			size_t pos;
 			size_t size;
@@ -145,9 +147,17 @@ MIO *mio_new_memory (unsigned char *data,
 					 size_t size,
 					 MIOReallocFunc realloc_func,
 					 MIODestroyNotify free_func);
+MIO *mio_new_memory_segments (unsigned char *head,
+							  size_t head_size,
+							  unsigned char *tail,
+							  size_t tail_size);
 int mio_free (MIO *mio);
 FILE *mio_file_get_fp (MIO *mio);
 unsigned char *mio_memory_get_data (MIO *mio, size_t *size);
+unsigned char *mio_memory_get_segments (MIO *mio,
+										size_t *head_size,
+										unsigned char **tail,
+										size_t *tail_size);
 size_t mio_read (MIO *mio,
 				 void *ptr,
 				 size_t size,
@@ -293,8 +293,10 @@ extern bool fileOpen (const char *const fileName, const langType language)
 /* The user should take care of allocate and free the buffer param. 
  * This func is NOT THREAD SAFE.
  * The user should not tamper with the buffer while this func is executing.
+ * tail, if not NULL, holds tail_size bytes of text following the buffer.
  */
 extern bool bufferOpen (unsigned char *buffer, size_t buffer_size,
+						unsigned char *tail, size_t tail_size,
 						const char *const fileName, const langType language )
 {
 	bool opened = false;
@@ -314,7 +316,7 @@ extern bool bufferOpen (unsigned char *buffer, size_t buffer_size,
 		
 	opened = true;
 			
-	File.mio = mio_new_memory (buffer, buffer_size, NULL, NULL);
+	File.mio = mio_new_memory_segments (buffer, buffer_size, tail, tail_size);
 	setInputFileName (fileName);
 	mio_getpos (File.mio, &StartOfLine);
 	mio_getpos (File.mio, &File.filePosition);
@@ -114,6 +114,7 @@ extern const unsigned char *readLineFromInputFile (void);
 extern char *readLineRaw (vString *const vLine, MIO *const mio);
 extern char *readSourceLine (vString *const vLine, MIOPos location, long *const pSeekValue);
 extern bool bufferOpen (unsigned char *buffer, size_t buffer_size,
+                        unsigned char *tail, size_t tail_size,
                         const char *const fileName, const langType language );
 #define bufferClose fileClose
 
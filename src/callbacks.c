@@ -442,6 +442,28 @@ void on_normal_size1_activate(GtkMenuItem *menuitem, gpointer user_data)
 }
 
 
+/* Loads a session file opened without its contents once its tab was switched to.
+ * This is not done from the switch-page handler itself, as loading can show dialogs
+ * and close the tab, which would change the notebook while it emits the signal. */
+static gboolean on_idle_load_pending(gpointer data)
+{
+	GeanyDocument *doc = document_find_by_id(GPOINTER_TO_UINT(data));
+
+	/* skip tabs that were closed, loaded or switched away from meanwhile */
+	if (doc == NULL || ! doc->priv->load_pending || doc != document_get_current())
+		return FALSE;
+
+	if (document_load_pending(doc))
+	{
+		ui_set_window_title(doc);
+		ui_update_statusbar(doc, -1);
+		sidebar_update_tag_list(doc, FALSE);
+		document_highlight_tags(doc);
+	}
+	return FALSE;
+}
+
+
 /* Changes window-title after switching tabs and lots of other things.
  * note: using 'after' makes Scintilla redraw before the UI, appearing more responsive */
 static void on_notebook1_switch_page_after(GtkNotebook *notebook, gpointer page,
@@ -456,6 +478,9 @@ static void on_notebook1_switch_page_after(GtkNotebook *notebook, gpointer page,
 
 	if (doc != NULL)
 	{
+		if (doc->priv->load_pending)
+			g_idle_add(on_idle_load_pending, GUINT_TO_POINTER(doc->id));
+
 		sidebar_select_openfiles_item(doc);
 		ui_save_buttons_toggle(doc->changed);
 		ui_set_window_title(doc);
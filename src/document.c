@@ -915,8 +915,9 @@ GeanyDocument *document_open_file(const gchar *locale_filename, gboolean readonl
 
 typedef struct
 {
-	gchar		*data;	/* null-terminated file data */
+	gchar		*data;	/* file data, null-terminated unless it points into map */
 	gsize		 len;	/* string length of data */
+	GMappedFile	*map;	/* the mapped file when data is used without a copy, or NULL */
 	gchar		*enc;
 	gboolean	 bom;
 	time_t		 mtime;	/* modification time, read by stat::st_mtime */
@@ -924,11 +925,52 @@ typedef struct
 } FileData;
 
 
-static gboolean get_mtime(const gchar *locale_filename, time_t *time)
+/* how many files document_read_ahead() reads ahead of the file being opened */
+#define READ_AHEAD_FILES 8
+
+/* smaller files are read rather than mapped, see can_map_file() */
+#define MAP_FILE_MIN_SIZE (256 * 1024)
+/* files modified less seconds ago are read rather than mapped */
+#define MAP_FILE_MIN_AGE 5
+
+/* A file queued by document_read_ahead(). The fields after done are set by
+ * the worker thread and may only be read once done is set. */
+typedef struct
+{
+	gchar		*locale_filename;
+	gchar		*forced_enc;
+	guint		 pos;		/* position in read_ahead.queue */
+	gboolean	 queued;	/* pushed to the thread pool */
+	gboolean	 done;		/* protected by read_ahead_mutex */
+	gboolean	 loaded;
+	gchar		*data;		/* null-terminated contents */
+	gsize		 len;
+	gchar		*enc;		/* "UTF-8" if the contents were found to be UTF-8, otherwise NULL */
+	guint		 bom_len;	/* length of the BOM skipped in data */
+	time_t		 mtime;
+} ReadAheadFile;
+
+static struct
+{
+	GThreadPool	*pool;
+	GPtrArray	*queue;		/* ReadAheadFile pointers in queue order, NULL once taken */
+	GHashTable	*files;		/* locale filename -> ReadAheadFile not taken yet */
+	guint		 next;		/* position of the next file to push to the pool */
+}
+read_ahead = {NULL, NULL, NULL, 0};
+
+static GMutex read_ahead_mutex;
+static GCond read_ahead_cond;
+
+
+/* Gets the modification time of locale_filename without reporting errors, so it
+ * can also be used by the read ahead threads. On failure, err_msg is set to a
+ * newly allocated error message. */
+static gboolean query_mtime(const gchar *locale_filename, time_t *time, gchar **err_msg)
 {
 	GError *error = NULL;
-	const gchar *err_msg = NULL;
 
+	*err_msg = NULL;
 	if (USE_GIO_FILE_OPERATIONS)
 	{
 		GFile *file = g_file_new_for_path(locale_filename);
@@ -943,7 +985,10 @@ static gboolean get_mtime(const gchar *locale_filename, time_t *time)
 			*time = timeval.tv_sec;
 		}
 		else if (error)
-			err_msg = error->message;
+		{
+			*err_msg = g_strdup(error->message);
+			g_error_free(error);
+		}
 
 		g_object_unref(file);
 	}
@@ -954,22 +999,209 @@ static gboolean get_mtime(const gchar *locale_filename, time_t *time)
 		if (g_stat(locale_filename, &st) == 0)
 			*time = st.st_mtime;
 		else
-			err_msg = g_strerror(errno);
+			*err_msg = g_strdup(g_strerror(errno));
 	}
 
-	if (err_msg)
+	return *err_msg == NULL;
+}
+
+
+static gboolean get_mtime(const gchar *locale_filename, time_t *time)
+{
+	gchar *err_msg;
+
+	if (! query_mtime(locale_filename, time, &err_msg))
 	{
 		gchar *utf8_filename = utils_get_utf8_from_locale(locale_filename);
 
 		ui_set_statusbar(TRUE, _("Could not open file %s (%s)"),
 			utf8_filename, err_msg);
 		g_free(utf8_filename);
+		g_free(err_msg);
+		return FALSE;
 	}
+	return TRUE;
+}
 
-	if (error)
-		g_error_free(error);
 
-	return err_msg == NULL;
+/* Whether the contents of locale_filename may be used from a mapping of the file
+ * instead of a copy. Reading a mapping of a file truncated by another process
+ * raises SIGBUS, so only map regular files big enough for the saved copy to
+ * matter and not modified recently, which rules out files still being written
+ * like logs (and truncated on rotation). Only for contents used right away, the
+ * mapping is released once Scintilla has copied the text. */
+static gboolean can_map_file(const gchar *locale_filename)
+{
+	GStatBuf st;
+
+	if (USE_GIO_FILE_OPERATIONS || g_stat(locale_filename, &st) != 0)
+		return FALSE;
+
+	return S_ISREG(st.st_mode) && st.st_size >= MAP_FILE_MIN_SIZE &&
+		time(NULL) - st.st_mtime > MAP_FILE_MIN_AGE;
+}
+
+
+/* Thread pool worker reading a file queued by document_read_ahead(). The contents
+ * are always read into memory: they may wait for a long time until their tab is
+ * opened, and a mapping of a file truncated meanwhile would raise SIGBUS when
+ * accessed (see can_map_file()). */
+static void read_ahead_file_contents(gpointer data, gpointer user_data)
+{
+	ReadAheadFile *file = data;
+	gchar *err_msg = NULL;
+
+	if (query_mtime(file->locale_filename, &file->mtime, &err_msg))
+	{
+		if (USE_GIO_FILE_OPERATIONS)
+		{
+			GFile *gfile = g_file_new_for_path(file->locale_filename);
+
+			file->loaded = g_file_load_contents(gfile, NULL, &file->data, &file->len, NULL, NULL);
+			g_object_unref(gfile);
+		}
+		else
+			file->loaded = g_file_get_contents(file->locale_filename, &file->data, &file->len, NULL);
+
+		/* without a forced encoding, the check looks for an encoding declaration
+		 * and logs it, which must happen on the main thread */
+		if (file->loaded && file->forced_enc != NULL &&
+			encodings_check_utf8_auto(file->data, file->len, file->forced_enc,
+				&file->enc, &file->bom_len))
+		{
+			memmove(file->data, file->data + file->bom_len, file->len - file->bom_len + 1);
+			file->len -= file->bom_len;
+		}
+	}
+	g_free(err_msg);
+
+	g_mutex_lock(&read_ahead_mutex);
+	file->done = TRUE;
+	g_cond_broadcast(&read_ahead_cond);
+	g_mutex_unlock(&read_ahead_mutex);
+}
+
+
+static void read_ahead_file_free(gpointer data)
+{
+	ReadAheadFile *file = data;
+
+	g_free(file->data);
+	g_free(file->enc);
+	g_free(file->forced_enc);
+	g_free(file->locale_filename);
+	g_free(file);
+}
+
+
+static gint get_read_ahead_thread_count(void)
+{
+	if (file_prefs.session_load_threads > 0)
+		return file_prefs.session_load_threads;
+#if GLIB_CHECK_VERSION(2, 36, 0)
+	return CLAMP((gint) g_get_num_processors(), 2, 8);
+#else
+	return 4;
+#endif
+}
+
+
+/* Queues the files up to READ_AHEAD_FILES after the given queue position */
+static void read_ahead_push_files(guint pos)
+{
+	for (; read_ahead.next < read_ahead.queue->len && read_ahead.next <= pos + READ_AHEAD_FILES;
+		read_ahead.next++)
+	{
+		ReadAheadFile *file = read_ahead.queue->pdata[read_ahead.next];
+
+		if (file)
+		{
+			file->queued = TRUE;
+			g_thread_pool_push(read_ahead.pool, file, NULL);
+		}
+	}
+}
+
+
+/* Queues locale_filename to be read by a pool of worker threads, so that a later
+ * document_open_file_full() on it only needs to wait for the disk if the workers
+ * did not get to it yet. Files are read in the order they are queued, and only
+ * a few files ahead of the files being opened.
+ * Call document_read_ahead_finish() once the files have been opened. */
+void document_read_ahead(const gchar *locale_filename, const gchar *forced_enc)
+{
+	ReadAheadFile *file;
+
+	if (read_ahead.pool == NULL)
+	{
+		read_ahead.pool = g_thread_pool_new(read_ahead_file_contents, NULL,
+			get_read_ahead_thread_count(), FALSE, NULL);
+		read_ahead.queue = g_ptr_array_new();
+		read_ahead.files = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, read_ahead_file_free);
+		read_ahead.next = 0;
+	}
+
+	file = g_new0(ReadAheadFile, 1);
+	file->locale_filename = g_strdup(locale_filename);
+	/* match the file name used by document_open_file_full() */
+	utils_tidy_path(file->locale_filename);
+	if (g_hash_table_lookup(read_ahead.files, file->locale_filename))
+	{
+		read_ahead_file_free(file);
+		return;
+	}
+	file->forced_enc = g_strdup(forced_enc);
+	file->pos = read_ahead.queue->len;
+	g_ptr_array_add(read_ahead.queue, file);
+	g_hash_table_insert(read_ahead.files, file->locale_filename, file);
+
+	read_ahead_push_files(0);
+}
+
+
+/* Drops any files not taken by document_open_file_full() */
+void document_read_ahead_finish(void)
+{
+	if (read_ahead.pool == NULL)
+		return;
+
+	g_thread_pool_free(read_ahead.pool, TRUE, TRUE);
+	read_ahead.pool = NULL;
+	g_hash_table_destroy(read_ahead.files);
+	read_ahead.files = NULL;
+	g_ptr_array_free(read_ahead.queue, TRUE);
+	read_ahead.queue = NULL;
+}
+
+
+/* Returns the file read ahead for locale_filename once it has been read, or NULL */
+static ReadAheadFile *read_ahead_take(const gchar *locale_filename, const gchar *forced_enc)
+{
+	ReadAheadFile *file;
+
+	if (read_ahead.pool == NULL ||
+		(file = g_hash_table_lookup(read_ahead.files, locale_filename)) == NULL)
+		return NULL;
+
+	g_hash_table_steal(read_ahead.files, locale_filename);
+	read_ahead.queue->pdata[file->pos] = NULL;
+	/* keep the workers busy with the files opened next */
+	read_ahead_push_files(file->pos);
+
+	if (file->queued)
+	{
+		g_mutex_lock(&read_ahead_mutex);
+		while (! file->done)
+			g_cond_wait(&read_ahead_cond, &read_ahead_mutex);
+		g_mutex_unlock(&read_ahead_mutex);
+	}
+
+	if (! file->loaded || ! utils_str_equal(file->forced_enc, forced_enc))
+	{
+		read_ahead_file_free(file);
+		return NULL;
+	}
+	return file;
 }
 
 
@@ -978,25 +1210,68 @@ static gboolean load_text_file(const gchar *locale_filename, const gchar *displa
 	FileData *filedata, const gchar *forced_enc)
 {
 	GError *err = NULL;
+	ReadAheadFile *ahead = read_ahead_take(locale_filename, forced_enc);
 
 	filedata->data = NULL;
 	filedata->len = 0;
+	filedata->map = NULL;
 	filedata->enc = NULL;
 	filedata->bom = FALSE;
 	filedata->readonly = FALSE;
 
-	if (!get_mtime(locale_filename, &filedata->mtime))
+	if (ahead != NULL)
+	{
+		gboolean utf8 = ahead->enc != NULL;
+
+		filedata->data = ahead->data;
+		filedata->len = ahead->len;
+		filedata->enc = ahead->enc;
+		filedata->bom = ahead->bom_len > 0;
+		filedata->mtime = ahead->mtime;
+		ahead->data = NULL;
+		ahead->enc = NULL;
+		read_ahead_file_free(ahead);
+
+		if (utf8)
+			return TRUE;
+	}
+	else if (!get_mtime(locale_filename, &filedata->mtime))
 		return FALSE;
 
-	if (USE_GIO_FILE_OPERATIONS)
+	/* big UTF-8 files are passed to Scintilla straight from the mapped file,
+	 * saving a copy of the whole file */
+	if (! filedata->data && can_map_file(locale_filename))
+		filedata->map = g_mapped_file_new(locale_filename, FALSE, NULL);
+	if (filedata->map)
 	{
-		GFile *file = g_file_new_for_path(locale_filename);
+		const gchar *contents = g_mapped_file_get_contents(filedata->map);
+		gsize length = g_mapped_file_get_length(filedata->map);
+		guint bom_len;
 
-		g_file_load_contents(file, NULL, &filedata->data, &filedata->len, NULL, &err);
-		g_object_unref(file);
+		if (encodings_check_utf8_auto(contents, length, forced_enc, &filedata->enc, &bom_len))
+		{
+			filedata->data = (gchar *) contents + bom_len;
+			filedata->len = length - bom_len;
+			filedata->bom = bom_len > 0;
+			return TRUE;
+		}
+		g_mapped_file_unref(filedata->map);
+		filedata->map = NULL;
+	}
+
+	/* the contents may have been read ahead already */
+	if (filedata->data == NULL)
+	{
+		if (USE_GIO_FILE_OPERATIONS)
+		{
+			GFile *file = g_file_new_for_path(locale_filename);
+
+			g_file_load_contents(file, NULL, &filedata->data, &filedata->len, NULL, &err);
+			g_object_unref(file);
+		}
+		else
+			g_file_get_contents(locale_filename, &filedata->data, &filedata->len, &err);
 	}
-	else
-		g_file_get_contents(locale_filename, &filedata->data, &filedata->len, &err);
 
 	if (err)
 	{
@@ -1287,7 +1562,8 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 		gboolean readonly, GeanyFiletype *ft, const gchar *forced_enc)
 {
 	gint editor_mode;
-	gboolean reload = (doc == NULL) ? FALSE : TRUE;
+	gboolean pending = (doc != NULL && doc->priv->load_pending);
+	gboolean reload = (doc == NULL || pending) ? FALSE : TRUE;
 	gchar *utf8_filename = NULL;
 	gchar *display_filename = NULL;
 	gchar *locale_filename = NULL;
@@ -1295,10 +1571,13 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 	FileData filedata;
 	UndoReloadData *undo_reload_data;
 	gboolean add_undo_reload_action;
+	GeanyIndentType indent_type = GEANY_INDENT_TYPE_SPACES;
+	gint indent_width = 0;
+	gboolean auto_indent = FALSE, line_wrapping = FALSE, line_breaking = FALSE;
 
 	g_return_val_if_fail(doc == NULL || doc->is_valid, NULL);
 
-	if (reload)
+	if (reload || pending)
 	{
 		utf8_filename = g_strdup(doc->file_name);
 		locale_filename = utils_get_locale_from_utf8(utf8_filename);
@@ -1330,7 +1609,7 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 			document_check_disk_status(doc, TRUE);	/* force a file changed check */
 		}
 	}
-	if (reload || doc == NULL)
+	if (reload || pending || doc == NULL)
 	{	/* doc possibly changed */
 		display_filename = utils_str_middle_truncate(utf8_filename, 100);
 
@@ -1342,7 +1621,20 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 			return NULL;
 		}
 
-		if (! reload)
+		if (pending)
+		{
+			/* keep the settings the session gave the editor */
+			indent_type = doc->editor->indent_type;
+			indent_width = doc->editor->indent_width;
+			auto_indent = doc->editor->auto_indent;
+			line_wrapping = doc->editor->line_wrapping;
+			line_breaking = doc->editor->line_breaking;
+
+			doc->priv->load_pending = FALSE;
+			/* let document_set_filetype() set up the filetype like for a new document */
+			doc->file_type = NULL;
+		}
+		else if (! reload)
 		{
 			doc = document_create(utf8_filename);
 			g_return_val_if_fail(doc != NULL, NULL); /* really should not happen */
@@ -1382,7 +1674,7 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 
 		/* add the text to the ScintillaObject */
 		sci_set_readonly(doc->editor->sci, FALSE);	/* to allow replacing text */
-		sci_set_text(doc->editor->sci, filedata.data);	/* NULL terminated data */
+		sci_set_text_len(doc->editor->sci, filedata.data, filedata.len);
 		queue_colourise(doc);	/* Ensure the document gets colourised. */
 
 		/* detect & set line endings */
@@ -1395,7 +1687,10 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 				add_undo_reload_action = TRUE;
 		}
 		sci_set_eol_mode(doc->editor->sci, editor_mode);
-		g_free(filedata.data);
+		if (filedata.map)
+			g_mapped_file_unref(filedata.map);
+		else
+			g_free(filedata.data);
 
 		sci_set_undo_collection(doc->editor->sci, TRUE);
 
@@ -1471,6 +1766,13 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 		/* set indentation settings after setting the filetype */
 		if (reload)
 			editor_set_indent(doc->editor, doc->editor->indent_type, doc->editor->indent_width); /* resetup sci */
+		else if (pending)
+		{
+			editor_set_indent(doc->editor, indent_type, indent_width);
+			editor_set_line_wrapping(doc->editor, line_wrapping);
+			doc->editor->line_breaking = line_breaking;
+			doc->editor->auto_indent = auto_indent;
+		}
 		else
 			document_apply_indent_settings(doc);
 
@@ -1478,7 +1780,7 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 		ui_document_show_hide(doc);	/* update the document menu */
 
 		/* finally add current file to recent files menu, but not the files from the last session */
-		if (! main_status.opening_session_files)
+		if (! main_status.opening_session_files && ! pending)
 			ui_add_recent_document(doc);
 
 		if (reload)
@@ -1517,6 +1819,93 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 }
 
 
+/* Adds a tab for locale_filename without reading the file, so that opening many session
+ * files only costs the work for the tabs actually shown. The file is loaded with
+ * forced_enc by document_load_pending() when the tab is first shown; until then the
+ * document has an empty, read-only editor and no tags, and "document-open" is only
+ * emitted once the file is loaded.
+ * Returns: doc of the new or already open file. */
+GeanyDocument *document_open_file_lazy(const gchar *locale_filename, gint pos,
+		gboolean readonly, GeanyFiletype *ft, const gchar *forced_enc)
+{
+	GeanyDocument *doc;
+	gchar *filename;
+	gchar *utf8_filename;
+
+	g_return_val_if_fail(locale_filename != NULL && forced_enc != NULL, NULL);
+
+	filename = g_strdup(locale_filename);
+	utils_tidy_path(filename);
+	utf8_filename = utils_get_utf8_from_locale(filename);
+
+	doc = document_find_by_filename(utf8_filename);
+	if (doc == NULL)
+	{
+		doc = document_create(utf8_filename);
+		g_return_val_if_fail(doc != NULL, NULL); /* really should not happen */
+
+		SETPTR(doc->real_path, utils_get_real_path(filename));
+		doc->priv->is_remote = utils_is_remote_path(filename);
+		monitor_file_setup(doc);
+
+		doc->priv->load_pending = TRUE;
+		doc->priv->pending_pos = pos;
+		doc->file_type = (ft != NULL) ? ft : filetypes_detect_from_extension(utf8_filename);
+		doc->encoding = g_strdup(forced_enc);
+		doc->readonly = readonly;
+		sci_set_readonly(doc->editor->sci, TRUE);
+
+		document_set_text_changed(doc, FALSE);	/* also updates tab state */
+		gtk_widget_show(document_get_notebook_child(doc));
+	}
+	g_free(utf8_filename);
+	g_free(filename);
+	return doc;
+}
+
+
+static gboolean on_idle_close_pending(gpointer data)
+{
+	GeanyDocument *doc = document_find_by_id(GPOINTER_TO_UINT(data));
+
+	/* the tab may have been closed or loaded meanwhile */
+	if (doc != NULL && doc->priv->load_pending)
+		document_close(doc);
+	return FALSE;
+}
+
+
+/* Loads the file of a document opened by document_open_file_lazy(), if not done yet.
+ * If the file can't be loaded, the error is shown and the tab is closed from an idle
+ * callback, so callers can still use doc until they return.
+ * Returns: FALSE if the file could not be loaded. */
+gboolean document_load_pending(GeanyDocument *doc)
+{
+	gchar *forced_enc;
+	gboolean ret;
+
+	g_return_val_if_fail(doc != NULL, FALSE);
+
+	if (! doc->priv->load_pending)
+		return TRUE;
+
+	/* the document's encoding is replaced while loading */
+	forced_enc = g_strdup(doc->encoding);
+	ret = document_open_file_full(doc, NULL, doc->priv->pending_pos, doc->readonly,
+		doc->file_type, forced_enc) != NULL;
+	g_free(forced_enc);
+
+	if (! ret)
+	{
+		/* the reason was already shown in the status bar, but the tab has to go as its
+		 * empty buffer must not be edited or saved */
+		ui_set_statusbar(TRUE, _("Could not load %s, closing it."), DOC_FILENAME(doc));
+		g_idle_add(on_idle_close_pending, GUINT_TO_POINTER(doc->id));
+	}
+	return ret;
+}
+
+
 /* Takes a new line separated list of filename URIs and opens each file.
  * length is the length of the string */
 void document_open_file_list(const gchar *data, gsize length)
@@ -1606,7 +1995,7 @@ gboolean document_reload_force(GeanyDocument *doc, const gchar *forced_enc)
 		gtk_info_bar_response(GTK_INFO_BAR(doc->priv->info_bars[MSG_TYPE_RELOAD]), GTK_RESPONSE_CANCEL);
 
 	/* try to set the cursor to the position before reloading */
-	pos = sci_get_current_position(doc->editor->sci);
+	pos = doc->priv->load_pending ? doc->priv->pending_pos : sci_get_current_position(doc->editor->sci);
 	new_doc = document_open_file_full(doc, NULL, pos, doc->readonly, doc->file_type, forced_enc);
 
 	if (file_prefs.keep_edit_history_on_reload && file_prefs.show_keep_edit_history_on_reload_msg)
@@ -1816,6 +2205,9 @@ gboolean document_save_file_as(GeanyDocument *doc, const gchar *utf8_fname)
 
 	g_return_val_if_fail(doc != NULL, FALSE);
 
+	if (! document_load_pending(doc))
+		return FALSE;
+
 	new_file = document_need_save_as(doc) || (utf8_fname != NULL && strcmp(doc->file_name, utf8_fname) != 0);
 	if (utf8_fname != NULL)
 		SETPTR(doc->file_name, g_strdup(utf8_fname));
@@ -2116,6 +2508,9 @@ gboolean document_save_file(GeanyDocument *doc, gboolean force)
 
 	if (!force && !doc->changed)
 		return FALSE;
+	/* never write the empty buffer of a file that wasn't loaded */
+	if (! document_load_pending(doc))
+		return FALSE;
 	if (doc->readonly)
 	{
 		ui_set_statusbar(TRUE,
@@ -2623,7 +3018,7 @@ gint document_replace_all(GeanyDocument *doc, const gchar *find_text, const gcha
 	gint len, count;
 	g_return_val_if_fail(doc != NULL && find_text != NULL && replace_text != NULL, FALSE);
 
-	if (! *find_text)
+	if (! *find_text || ! document_load_pending(doc))
 		return FALSE;
 
 	len = sci_get_length(doc->editor->sci);
@@ -2643,8 +3038,8 @@ gint document_replace_all(GeanyDocument *doc, const gchar *find_text, const gcha
  */
 void document_update_tags(GeanyDocument *doc)
 {
-	guchar *buffer_ptr;
-	gsize len;
+	gboolean new_tm_file = FALSE;
+	gboolean tags_changed = TRUE;
 
 	g_return_if_fail(DOC_VALID(doc));
 	g_return_if_fail(app->tm_workspace != NULL);
@@ -2671,7 +3066,10 @@ void document_update_tags(GeanyDocument *doc)
 		g_free(locale_filename);
 
 		if (doc->tm_file)
+		{
 			tm_workspace_add_source_file_noupdate(doc->tm_file);
+			new_tm_file = TRUE;
+		}
 	}
 
 	/* early out if there's no tm source file and we couldn't create one */
@@ -2684,13 +3082,38 @@ void document_update_tags(GeanyDocument *doc)
 		return;
 	}
 
-	/* Parse Scintilla's buffer directly using TagManager
-	 * Note: this buffer *MUST NOT* be modified */
-	len = sci_get_length(doc->editor->sci);
-	buffer_ptr = (guchar *) SSM(doc->editor->sci, SCI_GETCHARACTERPOINTER, 0, 0);
-	tm_workspace_update_source_file_buffer(doc->tm_file, buffer_ptr, len);
+	/* the tags of an unmodified buffer are still up to date (e.g. when saving after
+	 * the idle update already ran), don't parse it again */
+	if (new_tm_file || doc->priv->tags_outdated)
+	{
+		gsize len = sci_get_length(doc->editor->sci);
+		gsize gap = SSM(doc->editor->sci, SCI_GETGAPPOSITION, 0, 0);
+		guchar *buffer_ptr, *tail_ptr = NULL;
+
+		/* Parse Scintilla's buffer directly using TagManager
+		 * Note: this buffer *MUST NOT* be modified
+		 * SCI_GETCHARACTERPOINTER would move the gap to the end of the buffer, which
+		 * copies all the text after it, so pass the text before and after the gap
+		 * separately. Ranges not spanning the gap don't move it. */
+		if (gap == 0 || gap >= len)
+			buffer_ptr = (guchar *) SSM(doc->editor->sci, SCI_GETRANGEPOINTER, 0, len);
+		else
+		{
+			buffer_ptr = (guchar *) SSM(doc->editor->sci, SCI_GETRANGEPOINTER, 0, gap);
+			tail_ptr = (guchar *) SSM(doc->editor->sci, SCI_GETRANGEPOINTER, gap, len - gap);
+		}
+		tags_changed = tm_workspace_update_source_file_buffer(doc->tm_file, buffer_ptr,
+			tail_ptr ? gap : len, tail_ptr, tail_ptr ? len - gap : 0);
+		doc->priv->tags_outdated = FALSE;
+	}
 
-	sidebar_update_tag_list(doc, TRUE);
+	/* the symbol list shows the same tags when reparsing didn't change them, unless
+	 * their lines were shifted in place (the labels contain the line numbers) */
+	if (tags_changed || new_tm_file || doc->priv->tag_lines_shifted)
+	{
+		doc->priv->tag_lines_shifted = FALSE;
+		sidebar_update_tag_list(doc, TRUE);
+	}
 	document_highlight_tags(doc);
 }
 
@@ -2700,6 +3123,7 @@ void document_highlight_tags(GeanyDocument *doc)
 {
 	GString *keywords_str;
 	gint keyword_idx;
+	guint serial;
 
 	/* some filetypes support type keywords (such as struct names), but not
 	 * necessarily all filetypes for a particular scintilla lexer.  this
@@ -2730,6 +3154,12 @@ void document_highlight_tags(GeanyDocument *doc)
 	if (!app->tm_workspace->tags_array)
 		return;
 
+	/* the typenames didn't change since the keywords were set */
+	serial = tm_workspace_get_typename_serial(doc->file_type->lang);
+	if (serial == doc->priv->keyword_serial)
+		return;
+	doc->priv->keyword_serial = serial;
+
 	/* get any type keywords and tell scintilla about them
 	 * this will cause the type keywords to be colourized in scintilla */
 	keywords_str = symbols_find_typenames_as_string(doc->file_type->lang, FALSE);
@@ -2740,8 +3170,10 @@ void document_highlight_tags(GeanyDocument *doc)
 
 		if (hash != doc->priv->keyword_hash)
 		{
+			/* scintilla invalidates the styles of the document itself and restyles
+			 * the visible part on the next redraw, the rest when it is shown */
 			sci_set_keywords(doc->editor->sci, keyword_idx, keywords);
-			queue_colourise(doc); /* force re-highlighting the entire document */
+			gtk_widget_queue_draw(GTK_WIDGET(doc->editor->sci));
 			doc->priv->keyword_hash = hash;
 		}
 		g_free(keywords);
@@ -2803,6 +3235,9 @@ static void document_load_config(GeanyDocument *doc, GeanyFiletype *type,
 			symbols_global_tags_loaded(type->id);
 
 		highlighting_set_styles(doc->editor->sci, type);
+		/* the lexer's keywords were reset, set the typenames again */
+		doc->priv->keyword_hash = 0;
+		doc->priv->keyword_serial = 0;
 		editor_set_indentation_guides(doc->editor);
 		build_menu_update(doc);
 		queue_colourise(doc);
@@ -3703,9 +4138,10 @@ gboolean document_check_disk_status(GeanyDocument *doc, gboolean force)
 
 	g_return_val_if_fail(doc != NULL, FALSE);
 
-	/* ignore remote files and documents that have never been saved to disk */
+	/* ignore remote files, documents that have never been saved to disk and files
+	 * that are not loaded yet */
 	if (notebook_switch_in_progress() || file_prefs.disk_check_timeout == 0
-			|| doc->real_path == NULL || doc->priv->is_remote)
+			|| doc->real_path == NULL || doc->priv->is_remote || doc->priv->load_pending)
 		return FALSE;
 
 	use_gio_filemon = (doc->priv->monitor != NULL);
@@ -67,6 +67,8 @@ typedef struct GeanyFilePrefs
 	gboolean		keep_edit_history_on_reload; /* Keep undo stack upon, and allow undoing of, document reloading. */
 	gboolean		show_keep_edit_history_on_reload_msg; /* whether to show the message introducing the above feature */
  	gboolean		reload_clean_doc_on_file_change;
+	gint			session_load_threads; /* threads reading session files, 0 for automatic */
+	gboolean		lazy_session_tabs; /* only load session files when their tab is shown */
 }
 GeanyFilePrefs;
 
@@ -263,6 +265,15 @@ GeanyDocument *document_open_file_full(GeanyDocument *doc, const gchar *filename
 
 void document_open_file_list(const gchar *data, gsize length);
 
+GeanyDocument *document_open_file_lazy(const gchar *locale_filename, gint pos,
+		gboolean readonly, GeanyFiletype *ft, const gchar *forced_enc);
+
+gboolean document_load_pending(GeanyDocument *doc);
+
+void document_read_ahead(const gchar *locale_filename, const gchar *forced_enc);
+
+void document_read_ahead_finish(void);
+
 gboolean document_search_bar_find(GeanyDocument *doc, const gchar *text, gboolean inc,
 		gboolean backwards);
 
@@ -92,6 +92,7 @@ typedef struct GeanyDocumentPrivate
 	FileEncoding	 saved_encoding;
 	gboolean		 colourise_needed;	/* use document.c:queue_colourise() instead */
 	guint			 keyword_hash;	/* hash of keyword string used for typename colourisation */
+	guint			 keyword_serial;	/* tm_workspace_get_typename_serial() of keyword_hash */
 	gint			 line_count;		/* Number of lines in the document. */
 	gint			 symbol_list_sort_mode;
 	/* indicates whether a file is on a remote filesystem, works only with GIO/GVfs */
@@ -106,6 +107,10 @@ typedef struct GeanyDocumentPrivate
 	time_t			 mtime;
 	/* ID of the idle callback updating the tag list */
 	guint			 tag_list_update_source;
+	/* Whether the buffer was modified since its tags were last parsed */
+	gboolean		 tags_outdated;
+	/* Whether the tag lines were shifted since the symbol list was last updated */
+	gboolean		 tag_lines_shifted;
 	/* Whether it's temporarily protected (read-only and saving needs confirmation). Does
 	 * not imply doc->readonly as writable files can be protected */
 	gint			 protected;
@@ -113,6 +118,10 @@ typedef struct GeanyDocumentPrivate
 	GtkWidget		*info_bars[NUM_MSG_TYPES];
 	/* Keyed Data List to attach arbitrary data to the document */
 	GData			*data;
+	/* Whether the file is only loaded once the tab is shown, see document_open_file_lazy() */
+	gboolean		 load_pending;
+	/* Cursor position to restore when loading a pending document */
+	gint			 pending_pos;
 }
 GeanyDocumentPrivate;
 
@@ -1005,6 +1005,20 @@ static void auto_update_margin_width(GeanyEditor *editor)
 }
 
 
+/* Keeps the line numbers of the document's tags in sync with the edit until the
+ * delayed tag update reparses the buffer */
+static void shift_tag_lines(GeanyDocument *doc, SCNotification *nt)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	gint line = sci_get_line_from_position(sci, nt->position);
+	gboolean line_start = nt->position == sci_get_position_from_line(sci, line);
+
+	/* tag lines start from 1; the symbol list shows the lines, see document_update_tags() */
+	if (tm_source_file_shift_lines(doc->tm_file, line + 1, nt->linesAdded, line_start))
+		doc->priv->tag_lines_shifted = TRUE;
+}
+
+
 static void partial_complete(ScintillaObject *sci, const gchar *text)
 {
 	gint pos = sci_get_current_position(sci);
@@ -1130,6 +1144,9 @@ static gboolean on_editor_notify(G_GNUC_UNUSED GObject *object, GeanyEditor *edi
 			}
 			if (nt->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT))
 			{
+				if (nt->linesAdded != 0 && doc->tm_file != NULL)
+					shift_tag_lines(doc, nt);
+				doc->priv->tags_outdated = TRUE;
 				document_update_tag_list_in_idle(doc);
 			}
 			break;
@@ -610,6 +610,108 @@ void encodings_encoding_store_cell_data_func(GtkCellLayout *cell_layout,
 }
 
 
+/* Returns the length of the UTF-8 sequence starting at p, or 0 if the sequence is
+ * invalid or incomplete. Rejects overlong forms, surrogates and code points above
+ * U+10FFFF like g_utf8_validate(). */
+static gsize utf8_sequence_length(const guchar *p, const guchar *end)
+{
+	guchar min = 0x80, max = 0xbf;
+	gsize len, i;
+
+	if (*p >= 0xc2 && *p <= 0xdf)
+		len = 2;
+	else if (*p >= 0xe0 && *p <= 0xef)
+	{
+		len = 3;
+		if (*p == 0xe0)
+			min = 0xa0;
+		else if (*p == 0xed)
+			max = 0x9f;
+	}
+	else if (*p >= 0xf0 && *p <= 0xf4)
+	{
+		len = 4;
+		if (*p == 0xf0)
+			min = 0x90;
+		else if (*p == 0xf4)
+			max = 0x8f;
+	}
+	else
+		return 0;
+
+	if ((gsize) (end - p) < len || p[1] < min || p[1] > max)
+		return 0;
+	for (i = 2; i < len; i++)
+	{
+		if (p[i] < 0x80 || p[i] > 0xbf)
+			return 0;
+	}
+	return len;
+}
+
+
+/* Scans buffer in a single pass for the first null byte and checks whether the data
+ * before it is valid UTF-8. ASCII text, the bulk of most files, is checked a machine
+ * word at a time. Once the data is known to be invalid only the null byte is searched.
+ * Returns the offset of the first null byte, or size if there is none. */
+static gsize scan_utf8(const gchar *buffer, gsize size, gboolean *valid)
+{
+	const gsize low_bits = ((gsize) -1) / 0xff;
+	const gsize high_bits = low_bits * 0x80;
+	const guchar *start = (const guchar *) buffer;
+	const guchar *end = start + size;
+	const guchar *p = start;
+
+	*valid = TRUE;
+	while (p < end)
+	{
+		if (((gsize) p & (sizeof(gsize) - 1)) == 0)
+		{
+			while ((gsize) (end - p) >= sizeof(gsize))
+			{
+				gsize word;
+
+				memcpy(&word, p, sizeof(gsize));
+				/* stop at non-ASCII or null bytes */
+				if ((word & high_bits) || ((word - low_bits) & ~word & high_bits))
+					break;
+				p += sizeof(gsize);
+			}
+			if (p == end)
+				break;
+		}
+
+		if (*p == 0)
+			return p - start;
+		else if (*p < 0x80)
+			p++;
+		else
+		{
+			gsize len = utf8_sequence_length(p, end);
+
+			if (len == 0)
+			{
+				const guchar *nul = memchr(p, 0, end - p);
+
+				*valid = FALSE;
+				return nul ? (gsize) (nul - start) : size;
+			}
+			p += len;
+		}
+	}
+	return size;
+}
+
+
+/* Like g_utf8_validate() with a positive length, but faster on mostly ASCII text */
+static gboolean utf8_validate(const gchar *buffer, gsize size)
+{
+	gboolean valid;
+
+	return scan_utf8(buffer, size, &valid) == size && valid;
+}
+
+
 /**
  *  Tries to convert @a buffer into UTF-8 encoding from the encoding specified with @a charset.
  *  If @a fast is not set, additional checks to validate the converted string are performed.
@@ -642,7 +744,7 @@ gchar *encodings_convert_to_utf8_from_charset(const gchar *buffer, gssize size,
 		utf8_content = converted_contents;
 		if (conv_error != NULL) g_error_free(conv_error);
 	}
-	else if (conv_error != NULL || ! g_utf8_validate(converted_contents, bytes_written, NULL))
+	else if (conv_error != NULL || ! utf8_validate(converted_contents, bytes_written))
 	{
 		if (conv_error != NULL)
 		{
@@ -681,8 +783,9 @@ static gchar *encodings_check_regexes(const gchar *buffer, gsize size)
 }
 
 
+/* try_utf8 is FALSE if the buffer is known not to be valid UTF-8 */
 static gchar *encodings_convert_to_utf8_with_suggestion(const gchar *buffer, gssize size,
-		const gchar *suggested_charset, gchar **used_encoding)
+		const gchar *suggested_charset, gboolean try_utf8, gchar **used_encoding)
 {
 	const gchar *locale_charset = NULL;
 	const gchar *charset;
@@ -746,6 +849,9 @@ static gchar *encodings_convert_to_utf8_with_suggestion(const gchar *buffer, gss
 
 		if (G_UNLIKELY(charset == NULL))
 			continue;
+		/* don't convert the whole buffer to find out what we know already */
+		if (! try_utf8 && encodings_charset_equals(charset, "UTF-8"))
+			continue;
 
 		geany_debug("Trying to convert %" G_GSIZE_FORMAT " bytes of data from %s into UTF-8.",
 			size, charset);
@@ -789,7 +895,8 @@ gchar *encodings_convert_to_utf8(const gchar *buffer, gssize size, gchar **used_
 
 	/* first try to read the encoding from the file content */
 	regex_charset = encodings_check_regexes(buffer, size);
-	utf8 = encodings_convert_to_utf8_with_suggestion(buffer, size, regex_charset, used_encoding);
+	utf8 = encodings_convert_to_utf8_with_suggestion(buffer, size, regex_charset, TRUE,
+		used_encoding);
 	g_free(regex_charset);
 
 	return utf8;
@@ -869,6 +976,7 @@ typedef struct
 	gchar		*data;	/* null-terminated data */
 	gsize		 size;	/* actual data size */
 	gsize		 len;	/* string length of data */
+	gboolean	 utf8;	/* whether the len bytes of data are valid UTF-8 */
 	gchar		*enc;
 	gboolean	 bom;
 	gboolean	 partial;
@@ -883,7 +991,7 @@ handle_forced_encoding(BufferData *buffer, const gchar *forced_enc)
 
 	if (utils_str_equal(forced_enc, "UTF-8"))
 	{
-		if (! g_utf8_validate(buffer->data, buffer->len, NULL))
+		if (! buffer->utf8)
 		{
 			return FALSE;
 		}
@@ -955,7 +1063,7 @@ handle_encoding(BufferData *buffer, GeanyEncodingIndex enc_idx)
 
 			/* try UTF-8 first */
 			if (encodings_get_idx_from_charset(regex_charset) == GEANY_ENCODING_UTF_8 &&
-				(buffer->size == buffer->len) && g_utf8_validate(buffer->data, buffer->len, NULL))
+				(buffer->size == buffer->len) && buffer->utf8)
 			{
 				buffer->enc = g_strdup("UTF-8");
 			}
@@ -963,7 +1071,8 @@ handle_encoding(BufferData *buffer, GeanyEncodingIndex enc_idx)
 			{
 				/* detect the encoding */
 				gchar *converted_text = encodings_convert_to_utf8_with_suggestion(buffer->data,
-					buffer->size, regex_charset, &buffer->enc);
+					buffer->size, regex_charset, buffer->size == buffer->len && buffer->utf8,
+					&buffer->enc);
 
 				if (converted_text == NULL)
 				{
@@ -1062,8 +1171,8 @@ gboolean encodings_convert_to_utf8_auto(gchar **buf, gsize *size, const gchar *f
 
 	buffer.data = *buf;
 	buffer.size = *size;
-	/* use strlen to check for null chars */
-	buffer.len = strlen(buffer.data);
+	/* find null chars and validate UTF-8 at once */
+	buffer.len = scan_utf8(buffer.data, *size, &buffer.utf8);
 	buffer.enc = NULL;
 	buffer.bom = FALSE;
 	buffer.partial = FALSE;
@@ -1084,3 +1193,59 @@ gboolean encodings_convert_to_utf8_auto(gchar **buf, gsize *size, const gchar *f
 	*buf = buffer.data;
 	return TRUE;
 }
+
+
+/*
+ * Checks whether @a buf can be used as UTF-8 text without any conversion, the same
+ * way encodings_convert_to_utf8_auto() would detect it. Unlike the latter it doesn't
+ * need a modifiable null-terminated buffer, so it can check e.g. a mapped file.
+ *
+ * @param buf the data to check.
+ * @param size the size of @a buf.
+ * @param forced_enc forced encoding to use, or @c NULL
+ * @param used_encoding return location for the used encoding, or @c NULL
+ * @param bom_len return location for the length of the BOM to skip, or @c NULL
+ *
+ * @return @c TRUE if the data is UTF-8 text without null bytes, @c FALSE if it
+ * needs to be handled by encodings_convert_to_utf8_auto().
+ */
+gboolean encodings_check_utf8_auto(const gchar *buf, gsize size, const gchar *forced_enc,
+		gchar **used_encoding, guint *bom_len)
+{
+	GeanyEncodingIndex enc_idx;
+	gboolean valid;
+	guint len = 0;
+
+	if (size == 0 || scan_utf8(buf, size, &valid) != size)
+		return FALSE;
+	if (forced_enc != NULL && ! utils_str_equal(forced_enc, "UTF-8"))
+		return FALSE;
+
+	enc_idx = encodings_scan_unicode_bom(buf, size, &len);
+	if (enc_idx != GEANY_ENCODING_UTF_8)
+	{
+		gchar *regex_charset;
+		gboolean is_utf8;
+
+		if (enc_idx != GEANY_ENCODING_NONE)
+			return FALSE;
+		len = 0;
+
+		/* like handle_encoding(), only accept UTF-8 if the content doesn't
+		 * declare another encoding */
+		regex_charset = forced_enc ? NULL : encodings_check_regexes(buf, size);
+		is_utf8 = encodings_get_idx_from_charset(regex_charset) == GEANY_ENCODING_UTF_8;
+		g_free(regex_charset);
+		if (! is_utf8 || ! valid)
+			return FALSE;
+	}
+	/* a UTF-8 BOM is trusted like in handle_encoding(), but a forced encoding is verified */
+	else if (forced_enc != NULL && ! valid)
+		return FALSE;
+
+	if (used_encoding)
+		*used_encoding = g_strdup("UTF-8");
+	if (bom_len)
+		*bom_len = len;
+	return TRUE;
+}
@@ -2598,6 +2598,8 @@ static gboolean cb_func_document_action(guint key_id)
 			document_clone(doc);
 			break;
 		case GEANY_KEYS_DOCUMENT_RELOADTAGLIST:
+			/* document_update_tags() skips parsing unmodified buffers */
+			doc->priv->tags_outdated = TRUE;
 			document_update_tags(doc);
 			break;
 		case GEANY_KEYS_DOCUMENT_FOLDALL:
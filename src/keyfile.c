@@ -37,6 +37,7 @@
 #include "app.h"
 #include "build.h"
 #include "document.h"
+#include "documentprivate.h"
 #include "encodings.h"
 #include "encodingsprivate.h"
 #include "filetypes.h"
@@ -248,6 +249,10 @@ static void init_pref_groups(void)
 		"show_keep_edit_history_on_reload_msg", TRUE);
 	stash_group_add_boolean(group, &file_prefs.reload_clean_doc_on_file_change,
 		"reload_clean_doc_on_file_change", FALSE);
+	stash_group_add_integer(group, &file_prefs.session_load_threads,
+		"session_load_threads", 0);
+	stash_group_add_boolean(group, &file_prefs.lazy_session_tabs,
+		"lazy_session_tabs", FALSE);
 	/* for backwards-compatibility */
 	stash_group_add_integer(group, &editor_prefs.indentation->hard_tab_width,
 		"indent_hard_tab_width", 8);
@@ -341,7 +346,7 @@ static gchar *get_session_file_string(GeanyDocument *doc)
 	escaped_filename = g_uri_escape_string(locale_filename, NULL, TRUE);
 
 	fname = g_strdup_printf("%d;%s;%d;E%s;%d;%d;%d;%s;%d;%d",
-		sci_get_current_position(doc->editor->sci),
+		doc->priv->load_pending ? doc->priv->pending_pos : sci_get_current_position(doc->editor->sci),
 		ft->name,
 		doc->readonly,
 		doc->encoding,
@@ -1151,6 +1156,15 @@ gboolean configuration_load(void)
 }
 
 
+static const gchar *get_session_file_encoding(gchar **tmp)
+{
+	if (isdigit(tmp[3][0]))
+		return encodings_get_charset_from_index(atoi(tmp[3]));
+	else
+		return &(tmp[3][1]);
+}
+
+
 static gboolean open_session_file(gchar **tmp, guint len)
 {
 	guint pos;
@@ -1167,14 +1181,7 @@ static gboolean open_session_file(gchar **tmp, guint len)
 	pos = atoi(tmp[0]);
 	ft_name = tmp[1];
 	ro = atoi(tmp[2]);
-	if (isdigit(tmp[3][0]))
-	{
-		encoding = encodings_get_charset_from_index(atoi(tmp[3]));
-	}
-	else
-	{
-		encoding = &(tmp[3][1]);
-	}
+	encoding = get_session_file_encoding(tmp);
 	indent_type = atoi(tmp[4]);
 	auto_indent = atoi(tmp[5]);
 	line_wrapping = atoi(tmp[6]);
@@ -1188,8 +1195,12 @@ static gboolean open_session_file(gchar **tmp, guint len)
 	if (g_file_test(locale_filename, G_FILE_TEST_IS_REGULAR))
 	{
 		GeanyFiletype *ft = filetypes_lookup_by_name(ft_name);
-		GeanyDocument *doc = document_open_file_full(
-			NULL, locale_filename, pos, ro, ft, encoding);
+		GeanyDocument *doc;
+
+		if (file_prefs.lazy_session_tabs && encoding != NULL)
+			doc = document_open_file_lazy(locale_filename, pos, ro, ft, encoding);
+		else
+			doc = document_open_file_full(NULL, locale_filename, pos, ro, ft, encoding);
 
 		if (doc)
 		{
@@ -1215,17 +1226,61 @@ static gboolean open_session_file(gchar **tmp, guint len)
 }
 
 
+static void read_session_file_ahead(gint i)
+{
+	gchar **tmp = g_ptr_array_index(session_files, i);
+
+	if (tmp != NULL && g_strv_length(tmp) >= 8)
+	{
+		gchar *unescaped_filename = g_uri_unescape_string(tmp[7], NULL);
+		gchar *locale_filename = utils_get_locale_from_utf8(unescaped_filename);
+
+		/* like open_session_file(), which doesn't open other files; reading e.g.
+		 * a FIFO would block a worker and so the thread pool shutdown */
+		if (g_file_test(locale_filename, G_FILE_TEST_IS_REGULAR))
+			document_read_ahead(locale_filename, get_session_file_encoding(tmp));
+		g_free(locale_filename);
+		g_free(unescaped_filename);
+	}
+}
+
+
+/* Lets worker threads read the session files while the tabs are created, starting
+ * with the file of the tab to be shown */
+static void read_session_files_ahead(void)
+{
+	gint i;
+
+	/* tabs get the session order whichever way they are opened */
+	if (session_notebook_page >= 0 && session_notebook_page < (gint)session_files->len)
+		read_session_file_ahead(session_notebook_page);
+
+	for (i = 0; i < (gint)session_files->len; i++)
+	{
+		gint n = file_prefs.tab_order_ltr ? i : (gint)session_files->len - 1 - i;
+
+		if (n != session_notebook_page)
+			read_session_file_ahead(n);
+	}
+}
+
+
 /* Open session files
  * Note: notebook page switch handler and adding to recent files list is always disabled
  * for all files opened within this function */
 void configuration_open_files(void)
 {
+	GeanyDocument *doc;
 	gint i;
 	gboolean failure = FALSE;
 
 	/* necessary to set it to TRUE for project session support */
 	main_status.opening_session_files = TRUE;
 
+	/* lazy tabs only read the file of the tab shown at the end */
+	if (! file_prefs.lazy_session_tabs)
+		read_session_files_ahead();
+
 	i = file_prefs.tab_order_ltr ? 0 : (session_files->len - 1);
 	while (TRUE)
 	{
@@ -1253,6 +1308,7 @@ void configuration_open_files(void)
 		}
 	}
 
+	document_read_ahead_finish();
 	g_ptr_array_free(session_files, TRUE);
 	session_files = NULL;
 
@@ -1274,6 +1330,11 @@ void configuration_open_files(void)
 		gtk_notebook_set_current_page(GTK_NOTEBOOK(main_widgets.notebook), target_page);
 	}
 	main_status.opening_session_files = FALSE;
+
+	/* the page switch above loads a lazy tab, but not if nothing was switched */
+	doc = document_get_current();
+	if (doc != NULL)
+		document_load_pending(doc);
 }
 
 
@@ -109,6 +109,7 @@ static gchar *lib_vte = NULL;
 #endif
 static gboolean generate_tags = FALSE;
 static gboolean no_preprocessing = FALSE;
+static gboolean text_tags = FALSE;
 static gboolean ft_names = FALSE;
 static gboolean print_prefix = FALSE;
 #ifdef HAVE_PLUGINS
@@ -124,6 +125,7 @@ static GOptionEntry entries[] =
 	{ "ft-names", 0, 0, G_OPTION_ARG_NONE, &ft_names, N_("Print internal filetype names"), NULL },
 	{ "generate-tags", 'g', 0, G_OPTION_ARG_NONE, &generate_tags, N_("Generate global tags file (see documentation)"), NULL },
 	{ "no-preprocessing", 'P', 0, G_OPTION_ARG_NONE, &no_preprocessing, N_("Don't preprocess C/C++ files when generating tags file"), NULL },
+	{ "text-tags", 0, 0, G_OPTION_ARG_NONE, &text_tags, N_("Generate the tags file in the text format instead of the binary one"), NULL },
 #ifdef HAVE_SOCKET
 	{ "new-instance", 'i', 0, G_OPTION_ARG_NONE, &cl_options.new_instance, N_("Don't open files in a running instance, force opening a new instance"), NULL },
 	{ "socket-file", 0, 0, G_OPTION_ARG_FILENAME, &cl_options.socket_filename, N_("Use this socket filename for communication with a running Geany instance"), NULL },
@@ -602,7 +604,7 @@ static void parse_command_line_options(gint *argc, gchar ***argv)
 		gboolean ret;
 
 		filetypes_init_types();
-		ret = symbols_generate_global_tags(*argc, *argv, ! no_preprocessing);
+		ret = symbols_generate_global_tags(*argc, *argv, ! no_preprocessing, text_tags);
 		filetypes_free_types();
 		wait_for_input_on_windows();
 		exit(ret);
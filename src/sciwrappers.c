@@ -241,6 +241,19 @@ void sci_set_text(ScintillaObject *sci, const gchar *text)
 }
 
 
+/* Sets all text from a buffer of len bytes which needn't be null-terminated,
+ * as a single undo action like sci_set_text(). */
+void sci_set_text_len(ScintillaObject *sci, const gchar *text, gsize len)
+{
+	SSM(sci, SCI_BEGINUNDOACTION, 0, 0);
+	SSM(sci, SCI_SETTEXT, 0, (sptr_t) "");
+	/* avoid growing the buffer step by step while appending */
+	SSM(sci, SCI_ALLOCATE, len + 1, 0);
+	SSM(sci, SCI_APPENDTEXT, len, (sptr_t) text);
+	SSM(sci, SCI_ENDUNDOACTION, 0, 0);
+}
+
+
 gboolean sci_can_undo(ScintillaObject *sci)
 {
 	return SSM(sci, SCI_CANUNDO, 0, 0) != FALSE;
@@ -2153,6 +2153,9 @@ static gint find_document_usage(GeanyDocument *doc, const gchar *search_text, Ge
 
 	g_return_val_if_fail(DOC_VALID(doc), 0);
 
+	if (! document_load_pending(doc))
+		return 0;
+
 	short_file_name = g_path_get_basename(DOC_FILENAME(doc));
 
 	ttf.chrg.cpMin = 0;
@@ -211,13 +211,10 @@ GString *symbols_find_typenames_as_string(TMParserType lang, gboolean global)
 	guint j;
 	TMTag *tag;
 	GString *s = NULL;
-	GPtrArray *typedefs;
+	const GPtrArray *typedefs;
 	TMParserType tag_lang;
 
-	if (global)
-		typedefs = app->tm_workspace->global_typename_array;
-	else
-		typedefs = app->tm_workspace->typename_array;
+	typedefs = tm_workspace_get_typenames(lang, global);
 
 	if ((typedefs) && (typedefs->len > 0))
 	{
@@ -1301,8 +1298,11 @@ static void tags_table_value_free(gpointer data)
  *   on each tag;
  * - the other holding "tag-name":row references for tags having children, used to
  *   lookup for a parent in both passes, avoiding tree traversal.
+ *
+ * When @a filling is TRUE, the tree doesn't contain any tags yet and isn't shown
+ * by the tree view, so the first pass is skipped and no rows are expanded.
  */
-static void update_tree_tags(GeanyDocument *doc, GList **tags)
+static void update_tree_tags(GeanyDocument *doc, GList **tags, gboolean filling)
 {
 	GtkTreeStore *store = doc->priv->tag_store;
 	GtkTreeModel *model = GTK_TREE_MODEL(store);
@@ -1323,7 +1323,8 @@ static void update_tree_tags(GeanyDocument *doc, GList **tags)
 		TMTag *tag = item->data;
 		const gchar *name;
 
-		tags_table_insert(tags_table, tag, item);
+		if (!filling)
+			tags_table_insert(tags_table, tag, item);
 
 		name = get_parent_name(tag, doc->file_type->id);
 		if (name)
@@ -1334,7 +1335,7 @@ static void update_tree_tags(GeanyDocument *doc, GList **tags)
 	 * It is OK to delete them since we walk top down so we would remove
 	 * parents before checking for their children, thus never implicitly
 	 * deleting an updated child */
-	cont = gtk_tree_model_get_iter_first(model, &iter);
+	cont = !filling && gtk_tree_model_get_iter_first(model, &iter);
 	while (cont)
 	{
 		TMTag *tag;
@@ -1420,7 +1421,7 @@ static void update_tree_tags(GeanyDocument *doc, GList **tags)
 
 			/* only expand to the iter if the parent was empty, otherwise we let the
 			 * folding as it was before (already expanded, or closed by the user) */
-			expand = ! gtk_tree_model_iter_has_child(model, parent);
+			expand = ! filling && ! gtk_tree_model_iter_has_child(model, parent);
 
 			/* insert the new element */
 			name = get_symbol_name(doc, tag, parent_name != NULL);
@@ -1550,7 +1551,11 @@ static void sort_tree(GtkTreeStore *store, gboolean sort_by_name)
 
 gboolean symbols_recreate_tag_list(GeanyDocument *doc, gint sort_mode)
 {
+	GtkTreeModel *model = GTK_TREE_MODEL(doc->priv->tag_store);
+	GtkTreeView *view = GTK_TREE_VIEW(doc->priv->tag_tree);
+	GtkTreeIter iter;
 	GList *tags;
+	gboolean filling;
 
 	g_return_val_if_fail(DOC_VALID(doc), FALSE);
 
@@ -1558,7 +1563,16 @@ gboolean symbols_recreate_tag_list(GeanyDocument *doc, gint sort_mode)
 	if (tags == NULL)
 		return FALSE;
 
-	/* FIXME: Not sure why we detached the model here? */
+	/* When the list is filled for the first time, detach the model from the view
+	 * while adding and sorting the rows so the view doesn't have to handle a
+	 * signal for each of them, which is slow with many symbols. There is no
+	 * folding state to keep yet. */
+	filling = ! gtk_tree_model_get_iter_first(model, &iter);
+	if (filling)
+	{
+		g_object_ref(model);
+		gtk_tree_view_set_model(view, NULL);
+	}
 
 	/* disable sorting during update because the code doesn't support correctly
 	 * models that are currently being built */
@@ -1567,7 +1581,7 @@ gboolean symbols_recreate_tag_list(GeanyDocument *doc, gint sort_mode)
 	/* add grandparent type iters */
 	add_top_level_items(doc);
 
-	update_tree_tags(doc, &tags);
+	update_tree_tags(doc, &tags, filling);
 	g_list_free(tags);
 
 	hide_empty_rows(doc->priv->tag_store);
@@ -1578,6 +1592,14 @@ gboolean symbols_recreate_tag_list(GeanyDocument *doc, gint sort_mode)
 	sort_tree(doc->priv->tag_store, sort_mode == SYMBOLS_SORT_BY_NAME);
 	doc->priv->symbol_list_sort_mode = sort_mode;
 
+	if (filling)
+	{
+		gtk_tree_view_set_model(view, model);
+		g_object_unref(model);
+		/* like expanding each parent getting its first child in update_tree_tags() */
+		gtk_tree_view_expand_all(view);
+	}
+
 	return TRUE;
 }
 
@@ -1607,7 +1629,8 @@ static GeanyFiletype *detect_global_tags_filetype(const gchar *utf8_filename)
  * the relevant path.
  * Example:
  * CFLAGS=-I/home/user/libname-1.x geany -g libname.d.tags libname.h */
-int symbols_generate_global_tags(int argc, char **argv, gboolean want_preprocess)
+int symbols_generate_global_tags(int argc, char **argv, gboolean want_preprocess,
+	gboolean want_text)
 {
 	/* -E pre-process, -dD output user macros, -p prof info (?) */
 	const char pre_process[] = "gcc -E -dD -p -I.";
@@ -1648,7 +1671,7 @@ int symbols_generate_global_tags(int argc, char **argv, gboolean want_preprocess
 		geany_debug("Generating %s tags file.", ft->name);
 		tm_get_workspace();
 		status = tm_workspace_create_global_tags(command, (const char **) (argv + 2),
-												 argc - 2, tags_file, ft->lang);
+												 argc - 2, tags_file, ft->lang, want_text);
 		g_free(command);
 		symbols_finalize(); /* free c_tags_ignore data */
 		if (! status)
@@ -2338,7 +2361,7 @@ static gint get_current_tag_name(GeanyDocument *doc, gchar **tagname, TMTagType
 	if (parent >= 0 && doc->tm_file != NULL && doc->tm_file->tags_array != NULL &&
 		(! doc->changed || editor_prefs.autocompletion_update_freq > 0))
 	{
-		const TMTag *tag = tm_get_current_tag(doc->tm_file->tags_array, parent + 1, tag_types);
+		const TMTag *tag = tm_source_file_get_current_tag(doc->tm_file, parent + 1, tag_types);
 
 		if (tag)
 		{
@@ -2633,6 +2656,11 @@ void symbols_init(void)
 	ui_add_config_file_menu_item(f, NULL, NULL);
 	g_free(f);
 
+	/* tags of parsed files are cached so unchanged files don't need parsing next time */
+	f = g_build_filename(app->configdir, "tagcache", NULL);
+	tm_source_file_set_tag_cache_dir(f, VERSION);
+	g_free(f);
+
 	g_signal_connect(geany_object, "document-save", G_CALLBACK(on_document_save), NULL);
 
 	for (i = 0; i < G_N_ELEMENTS(symbols_icons); i++)
@@ -2645,6 +2673,7 @@ void symbols_finalize(void)
 	guint i;
 
 	g_strfreev(c_tags_ignore);
+	tm_source_file_set_tag_cache_dir(NULL, NULL);
 
 	for (i = 0; i < G_N_ELEMENTS(symbols_icons); i++)
 	{
@@ -26,6 +26,10 @@
 #include "read.h"
 
 
+/* the tokens ignored by the C-like parsers, exported by options.c */
+extern gchar **c_tags_ignore;
+
+
 typedef struct {
 	TMCtagsNewTagCallback tag_callback;
 	gpointer user_data;
@@ -47,7 +51,7 @@ static gboolean parse_callback(const tagEntryInfo *tag, gpointer user_data)
 }
 
 
-void tm_ctags_parse(guchar *buffer, gsize buffer_size,
+void tm_ctags_parse(guchar *buffer, gsize buffer_size, guchar *tail, gsize tail_size,
 	const gchar *file_name, TMParserType lang, TMCtagsNewTagCallback tag_callback,
 	TMCtagsPassStartCallback pass_callback, gpointer user_data)
 {
@@ -82,7 +86,7 @@ void tm_ctags_parse(guchar *buffer, gsize buffer_size,
 				retry = LanguageTable [lang]->parser2 (passCount);
 			fileClose ();
 		}
-		else if (buffer && bufferOpen (buffer, buffer_size, file_name, lang))
+		else if (buffer && bufferOpen (buffer, buffer_size, tail, tail_size, file_name, lang))
 		{
 			if (LanguageTable [lang]->parser != NULL)
 			{
@@ -169,3 +173,9 @@ guint tm_ctags_get_lang_count(void)
 {
 	return LanguageCount;
 }
+
+
+const gchar * const *tm_ctags_get_ignore_tags(void)
+{
+	return (const gchar * const *) c_tags_ignore;
+}
@@ -42,7 +42,7 @@ typedef gboolean (*TMCtagsPassStartCallback) (void *user_data);
 
 void tm_ctags_init(void);
 
-void tm_ctags_parse(guchar *buffer, gsize buffer_size,
+void tm_ctags_parse(guchar *buffer, gsize buffer_size, guchar *tail, gsize tail_size,
 	const gchar *file_name, TMParserType lang, TMCtagsNewTagCallback tag_callback,
 	TMCtagsPassStartCallback pass_callback, gpointer user_data);
 
@@ -60,6 +60,8 @@ gboolean tm_ctags_is_using_regex_parser(TMParserType lang);
 
 guint tm_ctags_get_lang_count(void);
 
+const gchar * const *tm_ctags_get_ignore_tags(void);
+
 G_END_DECLS
 
 #endif /* TM_CTAGS_WRAPPERS */
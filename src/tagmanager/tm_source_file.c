@@ -20,6 +20,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <glib/gstdio.h>
 #ifdef G_OS_WIN32
 # define VC_EXTRALEAN
@@ -36,15 +37,48 @@ typedef struct
 {
 	TMSourceFile public;
 	guint refcount;
+	gboolean parsed; /* whether the file has been parsed at least once */
+	/* tag types -> GPtrArray of the tags of the types sorted by line, built on demand */
+	GHashTable *line_index;
 } TMSourceFilePriv;
 
 
 typedef enum {
 	TM_FILE_FORMAT_TAGMANAGER,
 	TM_FILE_FORMAT_PIPE,
-	TM_FILE_FORMAT_CTAGS
+	TM_FILE_FORMAT_CTAGS,
+	TM_FILE_FORMAT_BINARY
 } TMFileFormat;
 
+/* The binary tags file format starts with the text line below followed by
+ * the number of tags, the size of the string table and the flags, all stored
+ * as little endian 32 bit integers. Then come the tag records, each consisting
+ * of TB_FIELD_COUNT such integers, and the string table with zero-terminated
+ * strings. String fields are offsets into the string table where 0 stands
+ * for NULL. */
+#define BINARY_TAGS_HEADER "# format=binary version=1\n"
+
+/* the tags are sorted and deduplicated on tm_tags_global_sort_attrs */
+#define BINARY_TAGS_FLAG_SORTED 1
+
+/* Note: To preserve binary compatibility, it is very important
+	that you only *append* to this list ! */
+enum
+{
+	TB_NAME,
+	TB_TYPE,
+	TB_LINE,
+	TB_LOCAL,
+	TB_POINTER,
+	TB_ARGLIST,
+	TB_SCOPE,
+	TB_INHERITS,
+	TB_VARTYPE,
+	TB_ACCESS,
+	TB_IMPL,
+	TB_FIELD_COUNT
+};
+
 /* Note: To preserve binary compatibility, it is very important
 	that you only *append* to this list ! */
 enum
@@ -70,6 +104,17 @@ enum
 #define SOURCE_FILE_NEW(S) ((S) = g_slice_new(TMSourceFilePriv))
 #define SOURCE_FILE_FREE(S) g_slice_free(TMSourceFilePriv, (TMSourceFilePriv *) S)
 
+/* increment when the format of the cached tags changes, parser changes are covered
+ * by the program version given to tm_source_file_set_tag_cache_dir() */
+#define TAG_CACHE_VERSION 3
+/* cache entries unused for longer than this (in seconds) are removed */
+#define TAG_CACHE_MAX_AGE (30 * 24 * 60 * 60)
+/* at most this many cache entries are kept, the least recently used ones are removed */
+#define TAG_CACHE_MAX_ENTRIES 2000
+
+static gchar *tag_cache_dir = NULL;
+static gchar *tag_cache_version = NULL;
+
 static int get_path_max(const char *path)
 {
 #ifdef PATH_MAX
@@ -185,20 +230,20 @@ static gboolean init_tag(TMTag *tag, TMSourceFile *file, const tagEntryInfo *tag
 	if (!tag_entry->name || type == tm_tag_undef_t)
 		return FALSE;
 
-	tag->name = g_strdup(tag_entry->name);
+	tag->name = tm_tag_intern_string(tag_entry->name);
 	tag->type = type;
 	tag->local = tag_entry->isFileScope;
 	tag->pointerOrder = 0;	/* backward compatibility (use var_type instead) */
 	tag->line = tag_entry->lineNumber;
 	if (NULL != tag_entry->extensionFields.signature)
-		tag->arglist = g_strdup(tag_entry->extensionFields.signature);
+		tag->arglist = tm_tag_intern_string(tag_entry->extensionFields.signature);
 	if ((NULL != tag_entry->extensionFields.scopeName) &&
 		(0 != tag_entry->extensionFields.scopeName[0]))
-		tag->scope = g_strdup(tag_entry->extensionFields.scopeName);
+		tag->scope = tm_tag_intern_string(tag_entry->extensionFields.scopeName);
 	if (tag_entry->extensionFields.inheritance != NULL)
-		tag->inheritance = g_strdup(tag_entry->extensionFields.inheritance);
+		tag->inheritance = tm_tag_intern_string(tag_entry->extensionFields.inheritance);
 	if (tag_entry->extensionFields.varType != NULL)
-		tag->var_type = g_strdup(tag_entry->extensionFields.varType);
+		tag->var_type = tm_tag_intern_string(tag_entry->extensionFields.varType);
 	if (tag_entry->extensionFields.access != NULL)
 		tag->access = get_tag_access(tag_entry->extensionFields.access);
 	if (tag_entry->extensionFields.implementation != NULL)
@@ -241,7 +286,7 @@ static gboolean init_tag_from_file(TMTag *tag, TMSourceFile *file, FILE *fp)
 			if (!isprint(*start))
 				return FALSE;
 			else
-				tag->name = g_strdup((gchar*)start);
+				tag->name = tm_tag_intern_string((gchar*)start);
 		}
 		else
 		{
@@ -257,19 +302,19 @@ static gboolean init_tag_from_file(TMTag *tag, TMSourceFile *file, FILE *fp)
 					tag->type = (TMTagType) atoi((gchar*)start + 1);
 					break;
 				case TA_ARGLIST:
-					tag->arglist = g_strdup((gchar*)start + 1);
+					tag->arglist = tm_tag_intern_string((gchar*)start + 1);
 					break;
 				case TA_SCOPE:
-					tag->scope = g_strdup((gchar*)start + 1);
+					tag->scope = tm_tag_intern_string((gchar*)start + 1);
 					break;
 				case TA_POINTER:
 					tag->pointerOrder = atoi((gchar*)start + 1);
 					break;
 				case TA_VARTYPE:
-					tag->var_type = g_strdup((gchar*)start + 1);
+					tag->var_type = tm_tag_intern_string((gchar*)start + 1);
 					break;
 				case TA_INHERITS:
-					tag->inheritance = g_strdup((gchar*)start + 1);
+					tag->inheritance = tm_tag_intern_string((gchar*)start + 1);
 					break;
 				case TA_TIME:  /* Obsolete */
 					break;
@@ -327,10 +372,10 @@ static gboolean init_tag_from_file_alt(TMTag *tag, TMSourceFile *file, FILE *fp)
 			fields = g_strsplit((gchar*)start, "|", -1);
 			field_len = g_strv_length(fields);
 
-			if (field_len >= 1) tag->name = g_strdup(fields[0]);
+			if (field_len >= 1) tag->name = tm_tag_intern_string(fields[0]);
 			else tag->name = NULL;
-			if (field_len >= 2 && fields[1] != NULL) tag->var_type = g_strdup(fields[1]);
-			if (field_len >= 3 && fields[2] != NULL) tag->arglist = g_strdup(fields[2]);
+			if (field_len >= 2 && fields[1] != NULL) tag->var_type = tm_tag_intern_string(fields[1]);
+			if (field_len >= 3 && fields[2] != NULL) tag->arglist = tm_tag_intern_string(fields[2]);
 			tag->type = tm_tag_prototype_t;
 			g_strfreev(fields);
 		}
@@ -345,32 +390,25 @@ static gboolean init_tag_from_file_alt(TMTag *tag, TMSourceFile *file, FILE *fp)
 /*
  CTags tag file format (http://ctags.sourceforge.net/FORMAT)
 */
-static gboolean init_tag_from_file_ctags(TMTag *tag, TMSourceFile *file, FILE *fp, TMParserType lang)
+static gboolean init_tag_from_file_ctags(TMTag *tag, TMSourceFile *file, gchar *buf, TMParserType lang)
 {
-	gchar buf[BUFSIZ];
 	gchar *p, *tab;
 
 	tag->refcount = 1;
 	tag->type = tm_tag_function_t; /* default type is function if no kind is specified */
-	do
-	{
-		if ((NULL == fgets(buf, BUFSIZ, fp)) || ('\0' == *buf))
-			return FALSE;
-	}
-	while (strncmp(buf, "!_TAG_", 6) == 0); /* skip !_TAG_ lines */
-
 	p = buf;
 
 	/* tag name */
 	if (! (tab = strchr(p, '\t')) || p == tab)
 		return FALSE;
-	tag->name = g_strndup(p, (gsize)(tab - p));
+	*tab = '\0';
+	tag->name = tm_tag_intern_string(p);
 	p = tab + 1;
 
 	/* tagfile, unused */
 	if (! (tab = strchr(p, '\t')))
 	{
-		g_free(tag->name);
+		tm_tag_release_string(tag->name);
 		tag->name = NULL;
 		return FALSE;
 	}
@@ -425,8 +463,8 @@ static gboolean init_tag_from_file_ctags(TMTag *tag, TMSourceFile *file, FILE *f
 			}
 			else if (0 == strcmp(key, "inherits")) /* comma-separated list of classes this class inherits from */
 			{
-				g_free(tag->inheritance);
-				tag->inheritance = g_strdup(value);
+				tm_tag_release_string(tag->inheritance);
+				tag->inheritance = tm_tag_intern_string(value);
 			}
 			else if (0 == strcmp(key, "implementation")) /* implementation limit */
 				tag->impl = get_tag_impl(value);
@@ -440,15 +478,15 @@ static gboolean init_tag_from_file_ctags(TMTag *tag, TMSourceFile *file, FILE *f
 					 0 == strcmp(key, "struct") ||
 					 0 == strcmp(key, "union")) /* Name of the class/enum/function/struct/union in which this tag is a member */
 			{
-				g_free(tag->scope);
-				tag->scope = g_strdup(value);
+				tm_tag_release_string(tag->scope);
+				tag->scope = tm_tag_intern_string(value);
 			}
 			else if (0 == strcmp(key, "file")) /* static (local) tag */
 				tag->local = TRUE;
 			else if (0 == strcmp(key, "signature")) /* arglist */
 			{
-				g_free(tag->arglist);
-				tag->arglist = g_strdup(value);
+				tm_tag_release_string(tag->arglist);
+				tag->arglist = tm_tag_intern_string(value);
 			}
 		}
 	}
@@ -471,7 +509,8 @@ static TMTag *new_tag_from_tags_file(TMSourceFile *file, FILE *fp, TMParserType
 			result = init_tag_from_file_alt(tag, file, fp);
 			break;
 		case TM_FILE_FORMAT_CTAGS:
-			result = init_tag_from_file_ctags(tag, file, fp, mode);
+			/* read by read_ctags_tags_file() without going through here */
+			g_warn_if_reached();
 			break;
 	}
 
@@ -521,7 +560,174 @@ static gboolean write_tag(TMTag *tag, FILE *fp, TMTagAttrType attrs)
 		return FALSE;
 }
 
-GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mode)
+static guint32 read_binary_value(const gchar *data, gsize index)
+{
+	guint32 value;
+
+	memcpy(&value, data + index * sizeof(guint32), sizeof(guint32));
+	return GUINT32_FROM_LE(value);
+}
+
+static gchar *intern_binary_string(const gchar *strings, guint32 strings_size, guint32 offset)
+{
+	if (offset == 0 || offset >= strings_size)
+		return NULL;
+	return tm_tag_intern_string(strings + offset);
+}
+
+/* Reads the tags of binary tags data (see BINARY_TAGS_HEADER) of the given length.
+ * Returns NULL when the data is truncated or otherwise broken. */
+static GPtrArray *read_binary_tags(const gchar *data, gsize length, TMParserType mode,
+	guint32 *flags)
+{
+	const gsize header_len = strlen(BINARY_TAGS_HEADER);
+	const gchar *records, *strings;
+	guint32 tag_count, strings_size, i;
+	GPtrArray *file_tags;
+
+	if (length < header_len + 3 * sizeof(guint32) ||
+		strncmp(data, BINARY_TAGS_HEADER, header_len) != 0)
+		return NULL;
+
+	records = data + header_len;
+	tag_count = read_binary_value(records, 0);
+	strings_size = read_binary_value(records, 1);
+	*flags = read_binary_value(records, 2);
+	records += 3 * sizeof(guint32);
+
+	/* make sure all records and a zero-terminated string table are present */
+	if (header_len + (3 + (guint64) tag_count * TB_FIELD_COUNT) * sizeof(guint32) +
+		strings_size > length || strings_size == 0)
+		return NULL;
+	strings = records + (gsize) tag_count * TB_FIELD_COUNT * sizeof(guint32);
+	if (strings[strings_size - 1] != '\0')
+		return NULL;
+
+	file_tags = g_ptr_array_sized_new(tag_count);
+	for (i = 0; i < tag_count; i++)
+	{
+		const gchar *record = records + (gsize) i * TB_FIELD_COUNT * sizeof(guint32);
+		TMTag *tag;
+		gchar *name;
+
+		name = intern_binary_string(strings, strings_size, read_binary_value(record, TB_NAME));
+		if (!name)
+			continue;
+
+		tag = tm_tag_new();
+		tag->name = name;
+		tag->type = read_binary_value(record, TB_TYPE);
+		tag->line = read_binary_value(record, TB_LINE);
+		tag->local = read_binary_value(record, TB_LOCAL);
+		tag->pointerOrder = read_binary_value(record, TB_POINTER);
+		tag->arglist = intern_binary_string(strings, strings_size, read_binary_value(record, TB_ARGLIST));
+		tag->scope = intern_binary_string(strings, strings_size, read_binary_value(record, TB_SCOPE));
+		tag->inheritance = intern_binary_string(strings, strings_size, read_binary_value(record, TB_INHERITS));
+		tag->var_type = intern_binary_string(strings, strings_size, read_binary_value(record, TB_VARTYPE));
+		tag->access = (char) read_binary_value(record, TB_ACCESS);
+		tag->impl = (char) read_binary_value(record, TB_IMPL);
+		tag->lang = mode;
+		g_ptr_array_add(file_tags, tag);
+	}
+	return file_tags;
+}
+
+/* Reads the tags of a binary tags file directly from the mapped file */
+static GPtrArray *read_binary_tags_file(const gchar *tags_file, TMParserType mode,
+	gboolean *sorted)
+{
+	GMappedFile *map = g_mapped_file_new(tags_file, FALSE, NULL);
+	GPtrArray *file_tags;
+	guint32 flags;
+
+	if (!map)
+		return NULL;
+
+	file_tags = read_binary_tags(g_mapped_file_get_contents(map),
+		g_mapped_file_get_length(map), mode, &flags);
+	g_mapped_file_unref(map);
+
+	if (file_tags && sorted)
+		*sorted = (flags & BINARY_TAGS_FLAG_SORTED) != 0;
+	return file_tags;
+}
+
+/* Reads the tags of a ctags file line by line from the mapped file, copying each
+ * line only into a reusable buffer. When the file claims to be sorted and no tag
+ * name repeats, the tags are in the order of the global tags array already. */
+static GPtrArray *read_ctags_tags_file(const gchar *tags_file, TMParserType mode,
+	gboolean *sorted)
+{
+	GMappedFile *map = g_mapped_file_new(tags_file, FALSE, NULL);
+	const gchar *data, *end, *line;
+	gchar *buf = NULL;
+	gsize buf_size = 0;
+	gboolean name_sorted = FALSE;
+	GPtrArray *file_tags;
+	TMTag *prev = NULL;
+
+	if (!map)
+		return NULL;
+
+	data = g_mapped_file_get_contents(map);
+	end = data + g_mapped_file_get_length(map);
+	file_tags = g_ptr_array_new();
+
+	for (line = data; line < end; )
+	{
+		const gchar *eol = memchr(line, '\n', end - line);
+		gsize len = (eol ? eol : end) - line;
+		TMTag *tag;
+
+		if (len >= 6 && strncmp(line, "!_TAG_", 6) == 0)
+		{
+			/* 1 means sorted by byte value, like strcmp() compares tag names */
+			if (len >= 19 && strncmp(line, "!_TAG_FILE_SORTED\t1", 19) == 0)
+				name_sorted = TRUE;
+			line += len + 1;
+			continue;
+		}
+
+		if (len + 1 > buf_size)
+		{
+			buf_size = MAX(len + 1, 2 * buf_size);
+			buf = g_realloc(buf, buf_size);
+		}
+		memcpy(buf, line, len);
+		buf[len] = '\0';
+		line += len + 1;
+
+		tag = tm_tag_new();
+		if (!init_tag_from_file_ctags(tag, NULL, buf, mode))
+		{
+			tm_tag_unref(tag);
+			continue;
+		}
+		tag->lang = mode;
+
+		/* a repeated name requires sorting by the other attributes and deduplication */
+		if (name_sorted && prev && strcmp(prev->name, tag->name) >= 0)
+			name_sorted = FALSE;
+		prev = tag;
+		g_ptr_array_add(file_tags, tag);
+	}
+	g_free(buf);
+	g_mapped_file_unref(map);
+
+	if (sorted)
+		*sorted = name_sorted;
+	return file_tags;
+}
+
+/* Reads the tags from a global tags file in any of the supported formats.
+ @param tags_file The tags file.
+ @param mode The language of the tags.
+ @param sorted Return location for whether the tags are already sorted by name,
+ type, scope and arglist, or NULL.
+ @return The tags or NULL on failure.
+*/
+GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mode,
+	gboolean *sorted)
 {
 	guchar buf[BUFSIZ];
 	FILE *fp;
@@ -529,6 +735,9 @@ GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mo
 	TMTag *tag;
 	TMFileFormat format = TM_FILE_FORMAT_TAGMANAGER;
 
+	if (sorted)
+		*sorted = FALSE;
+
 	if (NULL == (fp = g_fopen(tags_file, "r")))
 		return NULL;
 	if ((NULL == fgets((gchar*) buf, BUFSIZ, fp)) || ('\0' == *buf))
@@ -538,7 +747,12 @@ GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mo
 	}
 	else
 	{	/* We read the first line for the format specification. */
-		if (buf[0] == '#' && strstr((gchar*) buf, "format=pipe") != NULL)
+		if (strcmp((gchar*) buf, BINARY_TAGS_HEADER) == 0)
+		{
+			fclose(fp);
+			return read_binary_tags_file(tags_file, mode, sorted);
+		}
+		else if (buf[0] == '#' && strstr((gchar*) buf, "format=pipe") != NULL)
 			format = TM_FILE_FORMAT_PIPE;
 		else if (buf[0] == '#' && strstr((gchar*) buf, "format=tagmanager") != NULL)
 			format = TM_FILE_FORMAT_TAGMANAGER;
@@ -566,6 +780,12 @@ GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mo
 		rewind(fp); /* reset the file pointer, to start reading again from the beginning */
 	}
 
+	if (format == TM_FILE_FORMAT_CTAGS)
+	{
+		fclose(fp);
+		return read_ctags_tags_file(tags_file, mode, sorted);
+	}
+
 	file_tags = g_ptr_array_new();
 	while (NULL != (tag = new_tag_from_tags_file(NULL, fp, mode, format)))
 		g_ptr_array_add(file_tags, tag);
@@ -574,35 +794,337 @@ GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mo
 	return file_tags;
 }
 
-gboolean tm_source_file_write_tags_file(const gchar *tags_file, GPtrArray *tags_array)
+static void append_binary_value(GByteArray *array, guint32 value)
+{
+	value = GUINT32_TO_LE(value);
+	g_byte_array_append(array, (const guint8 *) &value, sizeof(guint32));
+}
+
+/* Returns the offset of str in the string table, adding it when not present yet */
+static guint32 get_binary_string_offset(GHashTable *offsets, GString *strings, const gchar *str)
 {
+	guint32 offset;
+
+	if (!str)
+		return 0;
+
+	offset = GPOINTER_TO_UINT(g_hash_table_lookup(offsets, str));
+	if (offset == 0)
+	{
+		offset = strings->len;
+		g_string_append_len(strings, str, strlen(str) + 1);
+		g_hash_table_insert(offsets, (gpointer) str, GUINT_TO_POINTER(offset));
+	}
+	return offset;
+}
+
+/* Writes the tags in the binary format (see BINARY_TAGS_HEADER) to fp */
+static gboolean write_binary_tags(FILE *fp, const GPtrArray *tags_array, guint32 flags)
+{
+	GHashTable *offsets = g_hash_table_new(g_str_hash, g_str_equal);
+	/* offset 0 stands for NULL strings */
+	GString *strings = g_string_new_len("", 1);
+	GByteArray *records = g_byte_array_new();
+	GByteArray *header = g_byte_array_new();
+	gboolean ret;
 	guint i;
-	FILE *fp;
-	gboolean ret = TRUE;
 
-	g_return_val_if_fail(tags_array && tags_file, FALSE);
+	for (i = 0; i < tags_array->len; i++)
+	{
+		TMTag *tag = TM_TAG(tags_array->pdata[i]);
+
+		append_binary_value(records, get_binary_string_offset(offsets, strings, tag->name));
+		append_binary_value(records, tag->type);
+		append_binary_value(records, tag->line);
+		append_binary_value(records, tag->local);
+		append_binary_value(records, tag->pointerOrder);
+		append_binary_value(records, get_binary_string_offset(offsets, strings, tag->arglist));
+		append_binary_value(records, get_binary_string_offset(offsets, strings, tag->scope));
+		append_binary_value(records, get_binary_string_offset(offsets, strings, tag->inheritance));
+		append_binary_value(records, get_binary_string_offset(offsets, strings, tag->var_type));
+		append_binary_value(records, (guchar) tag->access);
+		append_binary_value(records, (guchar) tag->impl);
+	}
 
-	fp = g_fopen(tags_file, "w");
-	if (!fp)
+	append_binary_value(header, tags_array->len);
+	append_binary_value(header, strings->len);
+	append_binary_value(header, flags);
+
+	ret = fputs(BINARY_TAGS_HEADER, fp) >= 0 &&
+		fwrite(header->data, 1, header->len, fp) == header->len &&
+		fwrite(records->data, 1, records->len, fp) == records->len &&
+		fwrite(strings->str, 1, strings->len, fp) == strings->len;
+
+	g_byte_array_free(header, TRUE);
+	g_byte_array_free(records, TRUE);
+	g_string_free(strings, TRUE);
+	g_hash_table_destroy(offsets);
+
+	return ret;
+}
+
+/* Writes the tags in the tagmanager text format to fp */
+static gboolean write_text_tags(FILE *fp, const GPtrArray *tags_array)
+{
+	guint i;
+
+	if (fprintf(fp, "# format=tagmanager\n") < 0)
 		return FALSE;
 
-	fprintf(fp, "# format=tagmanager\n");
 	for (i = 0; i < tags_array->len; i++)
 	{
 		TMTag *tag = TM_TAG(tags_array->pdata[i]);
 
-		ret = write_tag(tag, fp, tm_tag_attr_type_t
+		if (!write_tag(tag, fp, tm_tag_attr_type_t
 		  | tm_tag_attr_scope_t | tm_tag_attr_arglist_t | tm_tag_attr_vartype_t
-		  | tm_tag_attr_pointer_t);
-
-		if (!ret)
-			break;
+		  | tm_tag_attr_pointer_t))
+			return FALSE;
 	}
-	fclose(fp);
+	return TRUE;
+}
+
+/* Writes the tags sorted and deduplicated on tm_tags_global_sort_attrs, so that
+ binary tags files can be loaded without sorting them again.
+ @param tags_file The file to write.
+ @param tags_array The tags, which are left unchanged.
+ @param text Whether to write the tagmanager text format instead of the binary one,
+ for tools reading the tags files created by older versions.
+ @return TRUE on success, FALSE on failure.
+*/
+gboolean tm_source_file_write_tags_file(const gchar *tags_file, GPtrArray *tags_array,
+	gboolean text)
+{
+	GPtrArray *sorted_tags;
+	gboolean ret = FALSE;
+	guint i;
+	FILE *fp;
+
+	g_return_val_if_fail(tags_array && tags_file, FALSE);
+
+	/* sort a copy, the tags are owned by the passed array */
+	sorted_tags = g_ptr_array_sized_new(tags_array->len);
+	for (i = 0; i < tags_array->len; i++)
+		g_ptr_array_add(sorted_tags, tags_array->pdata[i]);
+	tm_tags_sort(sorted_tags, tm_tags_global_sort_attrs, TRUE, FALSE);
 
+	fp = g_fopen(tags_file, text ? "w" : "wb");
+	if (fp)
+	{
+		if (text)
+			ret = write_text_tags(fp, sorted_tags);
+		else
+			ret = write_binary_tags(fp, sorted_tags, BINARY_TAGS_FLAG_SORTED);
+		ret = (fclose(fp) == 0) && ret;
+	}
+	g_ptr_array_free(sorted_tags, TRUE);
 	return ret;
 }
 
+typedef struct
+{
+	gchar *path;
+	time_t mtime;
+} TagCacheEntry;
+
+static gint tag_cache_entry_cmp(gconstpointer a, gconstpointer b)
+{
+	const TagCacheEntry *entry_a = a;
+	const TagCacheEntry *entry_b = b;
+
+	/* most recently used first */
+	if (entry_a->mtime == entry_b->mtime)
+		return 0;
+	return entry_a->mtime > entry_b->mtime ? -1 : 1;
+}
+
+/* Removes cache entries (and files left by interrupted writes) that were not used
+ for TAG_CACHE_MAX_AGE, and the least recently used ones above TAG_CACHE_MAX_ENTRIES.
+ Reading an entry updates its modification time. Runs in its own thread so that
+ going through the directory doesn't delay the startup; takes ownership of the
+ directory name. */
+static gpointer prune_tag_cache(gpointer data)
+{
+	gchar *cache_dir = data;
+	GDir *dir = g_dir_open(cache_dir, 0, NULL);
+	GArray *entries;
+	const gchar *name;
+	time_t now = time(NULL);
+	guint i;
+
+	if (!dir)
+	{
+		g_free(cache_dir);
+		return NULL;
+	}
+
+	entries = g_array_new(FALSE, FALSE, sizeof(TagCacheEntry));
+	while ((name = g_dir_read_name(dir)) != NULL)
+	{
+		TagCacheEntry entry;
+		GStatBuf s;
+
+		if (!strstr(name, ".tags"))
+			continue;
+		entry.path = g_build_filename(cache_dir, name, NULL);
+		if (g_stat(entry.path, &s) == 0 && S_ISREG(s.st_mode))
+		{
+			entry.mtime = s.st_mtime;
+			g_array_append_val(entries, entry);
+		}
+		else
+			g_free(entry.path);
+	}
+	g_dir_close(dir);
+
+	g_array_sort(entries, tag_cache_entry_cmp);
+	for (i = 0; i < entries->len; i++)
+	{
+		TagCacheEntry *entry = &g_array_index(entries, TagCacheEntry, i);
+
+		if (i >= TAG_CACHE_MAX_ENTRIES || now - entry->mtime > TAG_CACHE_MAX_AGE)
+			g_unlink(entry->path);
+		g_free(entry->path);
+	}
+	g_array_free(entries, TRUE);
+	g_free(cache_dir);
+	return NULL;
+}
+
+/* Sets the directory where the tags of parsed source files are cached, NULL to
+ disable the cache. A source file whose contents match the cached entry gets its
+ tags loaded from the cache on the first parse instead of running the parser.
+ Old entries are removed from the directory in the background.
+ @param dir The cache directory (created when needed), or NULL.
+ @param version The program version, entries written by other versions are not used.
+*/
+void tm_source_file_set_tag_cache_dir(const gchar *dir, const gchar *version)
+{
+	g_free(tag_cache_dir);
+	tag_cache_dir = g_strdup(dir);
+	g_free(tag_cache_version);
+	tag_cache_version = g_strdup(version);
+
+	if (tag_cache_dir)
+	{
+		gchar *cache_dir = g_strdup(tag_cache_dir);
+		GThread *thread = g_thread_try_new("tag cache pruning", prune_tag_cache, cache_dir, NULL);
+
+		/* the cache only grows further until the next start */
+		if (thread)
+			g_thread_unref(thread);
+		else
+			g_free(cache_dir);
+	}
+}
+
+/* Buffer parses (UTF-8 converted text) and file parses (raw file contents) use
+ * separate entries so that they don't keep replacing each other */
+static gchar *get_tag_cache_file_name(const TMSourceFile *source_file, gboolean use_buffer)
+{
+	gchar *checksum = g_compute_checksum_for_string(G_CHECKSUM_MD5, source_file->file_name, -1);
+	gchar *base_name = g_strconcat(checksum, use_buffer ? ".tags" : "-file.tags", NULL);
+	gchar *cache_file_name = g_build_filename(tag_cache_dir, base_name, NULL);
+
+	g_free(base_name);
+	g_free(checksum);
+	return cache_file_name;
+}
+
+/* The cached tags are valid only for the same file (part of the cache file name),
+ * language, cache format, program version, ignored tokens and contents */
+static gchar *get_tag_cache_key(const TMSourceFile *source_file, const guchar *text_buf,
+	gsize buf_size, const guchar *tail_buf, gsize tail_size)
+{
+	GChecksum *checksum = g_checksum_new(G_CHECKSUM_MD5);
+	GChecksum *ignore_checksum = g_checksum_new(G_CHECKSUM_MD5);
+	const gchar * const *ignore;
+	gchar *key;
+
+	g_checksum_update(checksum, text_buf, buf_size);
+	if (tail_buf)
+		g_checksum_update(checksum, tail_buf, tail_size);
+	/* the ignore list changes the output of the C-like parsers */
+	for (ignore = tm_ctags_get_ignore_tags(); ignore && *ignore; ignore++)
+		g_checksum_update(ignore_checksum, (const guchar *) *ignore, strlen(*ignore) + 1);
+
+	key = g_strdup_printf("# format=tagcache version=%d program=%s lang=%s ignore=%s size=%"
+		G_GSIZE_FORMAT " md5=%s path=%s\n", TAG_CACHE_VERSION, tag_cache_version,
+		tm_source_file_get_lang_name(source_file->lang), g_checksum_get_string(ignore_checksum),
+		buf_size + tail_size, g_checksum_get_string(checksum), source_file->file_name);
+
+	g_checksum_free(ignore_checksum);
+	g_checksum_free(checksum);
+	return key;
+}
+
+/* A cache entry consists of the key line followed by the tags in the binary format */
+static gboolean read_tag_cache(TMSourceFile *source_file, const gchar *key, gboolean use_buffer)
+{
+	gchar *cache_file_name = get_tag_cache_file_name(source_file, use_buffer);
+	gsize key_len = strlen(key);
+	gchar *contents;
+	gsize length;
+	GPtrArray *tags = NULL;
+	guint32 flags;
+	guint i;
+
+	/* entries are replaced by renaming, so they are read as a whole rather than mapped */
+	if (!g_file_get_contents(cache_file_name, &contents, &length, NULL))
+	{
+		g_free(cache_file_name);
+		return FALSE;
+	}
+
+	/* entries with a different key are left alone, they get overwritten after parsing */
+	if (length >= key_len && strncmp(contents, key, key_len) == 0)
+		tags = read_binary_tags(contents + key_len, length - key_len, source_file->lang, &flags);
+	g_free(contents);
+
+	if (tags)
+	{
+		for (i = 0; i < tags->len; i++)
+		{
+			TMTag *tag = tags->pdata[i];
+
+			tag->file = source_file;
+			g_ptr_array_add(source_file->tags_array, tag);
+		}
+		g_ptr_array_free(tags, TRUE);
+
+		/* mark the entry as recently used for prune_tag_cache() */
+		g_utime(cache_file_name, NULL);
+	}
+	g_free(cache_file_name);
+	return tags != NULL;
+}
+
+static void write_tag_cache(const TMSourceFile *source_file, const gchar *key,
+	gboolean use_buffer)
+{
+	gchar *cache_file_name;
+	gchar *tmp_file_name;
+	FILE *fp;
+
+	if (g_mkdir_with_parents(tag_cache_dir, 0700) != 0)
+		return;
+
+	/* write to a temporary file and rename it so that readers (including other
+	 * instances) never see a partially written entry */
+	cache_file_name = get_tag_cache_file_name(source_file, use_buffer);
+	tmp_file_name = g_strdup_printf("%s.%08x", cache_file_name, g_random_int());
+	fp = g_fopen(tmp_file_name, "wb");
+	if (fp)
+	{
+		gboolean ret = fputs(key, fp) >= 0 &&
+			write_binary_tags(fp, source_file->tags_array, 0);
+
+		if (fclose(fp) != 0 || !ret || g_rename(tmp_file_name, cache_file_name) != 0)
+			g_unlink(tmp_file_name);
+	}
+	g_free(tmp_file_name);
+	g_free(cache_file_name);
+}
+
 /* add argument list of __init__() Python methods to the class tag */
 static void update_python_arglist(const TMTag *tag, TMSourceFile *current_source_file)
 {
@@ -625,8 +1147,8 @@ static void update_python_arglist(const TMTag *tag, TMSourceFile *current_source
 		TMTag *prev_tag = (TMTag *) current_source_file->tags_array->pdata[i - 1];
 		if (g_strcmp0(prev_tag->name, parent_tag_name) == 0)
 		{
-			g_free(prev_tag->arglist);
-			prev_tag->arglist = g_strdup(tag->arglist);
+			tm_tag_release_string(prev_tag->arglist);
+			prev_tag->arglist = tm_tag_intern_string(tag->arglist);
 			break;
 		}
 	}
@@ -722,6 +1244,8 @@ TMSourceFile *tm_source_file_new(const char *file_name, const char *name)
 		return NULL;
 	}
 	priv->refcount = 1;
+	priv->parsed = FALSE;
+	priv->line_index = NULL;
 	return &priv->public;
 }
 
@@ -740,12 +1264,22 @@ static TMSourceFile *tm_source_file_dup(TMSourceFile *source_file)
  source file and are also destroyed when the source file is destroyed. If pointers
  to these tags are used elsewhere, then those tag arrays should be rebuilt.
 */
+static void free_line_index(TMSourceFilePriv *priv)
+{
+	if (priv->line_index)
+		g_hash_table_destroy(priv->line_index);
+	priv->line_index = NULL;
+}
+
+
 static void tm_source_file_destroy(TMSourceFile *source_file)
 {
 #ifdef TM_DEBUG
 	g_message("Destroying source file: %s", source_file->file_name);
 #endif
 
+	free_line_index((TMSourceFilePriv *) source_file);
+
 	g_free(source_file->file_name);
 	tm_tags_array_free(source_file->tags_array, TRUE);
 	source_file->tags_array = NULL;
@@ -783,14 +1317,19 @@ G_DEFINE_BOXED_TYPE(TMSourceFile, tm_source_file, tm_source_file_dup, tm_source_
  @param source_file The source file to parse
  @param text_buf The text buffer to parse
  @param buf_size The size of text_buf.
+ @param tail_buf The text following text_buf when the text isn't contiguous in memory
+ (like in Scintilla's buffer, which is split by its gap), or NULL.
+ @param tail_size The size of tail_buf.
  @param use_buffer Set FALSE to ignore the buffer and parse the file directly or
  TRUE to parse the buffer and ignore the file content.
  @return TRUE on success, FALSE on failure
 */
 gboolean tm_source_file_parse(TMSourceFile *source_file, guchar* text_buf, gsize buf_size,
-	gboolean use_buffer)
+	guchar *tail_buf, gsize tail_size, gboolean use_buffer)
 {
+	TMSourceFilePriv *priv = (TMSourceFilePriv *) source_file;
 	const char *file_name;
+	gchar *cache_key = NULL;
 	gboolean retry = TRUE;
 	gboolean parse_file = FALSE;
 	gboolean free_buf = FALSE;
@@ -800,6 +1339,8 @@ gboolean tm_source_file_parse(TMSourceFile *source_file, guchar* text_buf, gsize
 		g_warning("Attempt to parse NULL file");
 		return FALSE;
 	}
+
+	free_line_index(priv);
 	
 	if (source_file->lang == TM_PARSER_NONE)
 	{
@@ -812,6 +1353,9 @@ gboolean tm_source_file_parse(TMSourceFile *source_file, guchar* text_buf, gsize
 	if (!use_buffer)
 	{
 		GStatBuf s;
+
+		tail_buf = NULL;
+		tail_size = 0;
 		
 		/* load file to memory and parse it from memory unless the file is too big */
 		if (g_stat(file_name, &s) != 0 || s.st_size > 10*1024*1024)
@@ -838,14 +1382,151 @@ gboolean tm_source_file_parse(TMSourceFile *source_file, guchar* text_buf, gsize
 
 	tm_tags_array_free(source_file->tags_array, FALSE);
 
-	tm_ctags_parse(parse_file ? NULL : text_buf, buf_size, file_name,
-		source_file->lang, ctags_new_tag, ctags_pass_start, source_file);
+	/* only the first parse uses the cache - later parses are caused by edits */
+	if (!parse_file && tag_cache_dir && !priv->parsed)
+		cache_key = get_tag_cache_key(source_file, text_buf, buf_size, tail_buf, tail_size);
+	priv->parsed = TRUE;
+
+	if (!cache_key || !read_tag_cache(source_file, cache_key, use_buffer))
+	{
+		tm_ctags_parse(parse_file ? NULL : text_buf, buf_size, tail_buf, tail_size, file_name,
+			source_file->lang, ctags_new_tag, ctags_pass_start, source_file);
 
+		if (cache_key)
+			write_tag_cache(source_file, cache_key, use_buffer);
+	}
+
+	g_free(cache_key);
 	if (free_buf)
 		g_free(text_buf);
 	return !retry;
 }
 
+/* Moves the tags following an edit by the number of lines the edit added or removed
+ so they point to the right lines until the file gets parsed again. All moved tags
+ end up after the line of the edit, so the relative order of the tags is preserved
+ and no tag array or index needs to be sorted again.
+ When tags are inside removed lines, they would end up on the line of the edit next
+ to the tags already there, in an order which may not match the sorting of the tag
+ arrays anymore, so no tags are moved. The file has to be parsed again then, which
+ it has to after any edit anyway.
+ @param source_file The source file whose tags are updated.
+ @param line The line (starting from 1) where the edit happened.
+ @param lines_added The number of lines added by the edit, negative for removed lines.
+ @param line_start Whether the edit happened at the beginning of the line.
+ @return TRUE if the tags were moved, FALSE if they were left alone.
+*/
+gboolean tm_source_file_shift_lines(TMSourceFile *source_file, gulong line, glong lines_added,
+	gboolean line_start)
+{
+	guint i;
+
+	g_return_val_if_fail(source_file != NULL, FALSE);
+
+	if (lines_added == 0)
+		return FALSE;
+
+	if (lines_added < 0)
+	{
+		for (i = 0; i < source_file->tags_array->len; i++)
+		{
+			TMTag *tag = source_file->tags_array->pdata[i];
+
+			/* the lines after line up to line - lines_added are joined with line */
+			if (tag->line > line && tag->line <= line - lines_added)
+				return FALSE;
+		}
+	}
+
+	for (i = 0; i < source_file->tags_array->len; i++)
+	{
+		TMTag *tag = source_file->tags_array->pdata[i];
+
+		if (tag->line > line || (tag->line == line && line_start && lines_added > 0))
+			tag->line += lines_added;
+	}
+	return TRUE;
+}
+
+static void line_index_value_free(gpointer data)
+{
+	g_ptr_array_free(data, TRUE);
+}
+
+
+static gint tag_line_compare(gconstpointer a, gconstpointer b)
+{
+	const TMTag *t1 = *((const TMTag **) a);
+	const TMTag *t2 = *((const TMTag **) b);
+
+	return (t1->line > t2->line) - (t1->line < t2->line);
+}
+
+
+/* Gets the tag of the given types which is the closest to the given line from above,
+ like tm_get_current_tag() but using a binary search. The tags of each combination
+ of types are sorted by line once after parsing the file.
+ @param source_file The source file whose tags are searched.
+ @param line The line (starting from 1).
+ @param tag_types The tag types to include in the match.
+ @return The matching tag, or NULL.
+*/
+const TMTag *tm_source_file_get_current_tag(TMSourceFile *source_file, gulong line,
+	TMTagType tag_types)
+{
+	TMSourceFilePriv *priv = (TMSourceFilePriv *) source_file;
+	GPtrArray *tags;
+	guint low, high;
+
+	g_return_val_if_fail(source_file != NULL, NULL);
+
+	if (!priv->line_index)
+		priv->line_index = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, line_index_value_free);
+
+	tags = g_hash_table_lookup(priv->line_index, GUINT_TO_POINTER(tag_types));
+	if (!tags)
+	{
+		guint i;
+
+		tags = g_ptr_array_new();
+		for (i = 0; i < source_file->tags_array->len; i++)
+		{
+			TMTag *tag = source_file->tags_array->pdata[i];
+
+			if (tag->type & tag_types)
+				g_ptr_array_add(tags, tag);
+		}
+		/* the sort is stable so tags on the same line keep the order of tags_array */
+		g_ptr_array_sort(tags, tag_line_compare);
+		g_hash_table_insert(priv->line_index, GUINT_TO_POINTER(tag_types), tags);
+	}
+
+	/* find the first tag after the line */
+	low = 0;
+	high = tags->len;
+	while (low < high)
+	{
+		guint mid = low + (high - low) / 2;
+
+		if (TM_TAG(tags->pdata[mid])->line <= line)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low == 0 || TM_TAG(tags->pdata[low - 1])->line == 0)
+		return NULL;
+
+	/* the first of the tags on the closest line */
+	for (low--; low > 0; low--)
+	{
+		if (TM_TAG(tags->pdata[low - 1])->line != TM_TAG(tags->pdata[low])->line)
+			break;
+	}
+	return tags->pdata[low];
+}
+
 /* Gets the name associated with the language index.
  @param lang The language index.
  @return The language name, or NULL.
@@ -55,11 +55,21 @@ const gchar *tm_source_file_get_lang_name(TMParserType lang);
 TMParserType tm_source_file_get_named_lang(const gchar *name);
 
 gboolean tm_source_file_parse(TMSourceFile *source_file, guchar* text_buf, gsize buf_size,
-	gboolean use_buffer);
+	guchar *tail_buf, gsize tail_size, gboolean use_buffer);
 
-GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mode);
+void tm_source_file_set_tag_cache_dir(const gchar *dir, const gchar *version);
 
-gboolean tm_source_file_write_tags_file(const gchar *tags_file, GPtrArray *tags_array);
+gboolean tm_source_file_shift_lines(TMSourceFile *source_file, gulong line, glong lines_added,
+	gboolean line_start);
+
+const struct TMTag *tm_source_file_get_current_tag(TMSourceFile *source_file, gulong line,
+	TMTagType tag_types);
+
+GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mode,
+	gboolean *sorted);
+
+gboolean tm_source_file_write_tags_file(const gchar *tags_file, GPtrArray *tags_array,
+	gboolean text);
 
 #endif /* GEANY_PRIVATE */
 
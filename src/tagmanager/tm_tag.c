@@ -74,6 +74,21 @@ static void log_tag_free(TMTag *tag)
 #endif /* DEBUG_TAG_REFS */
 
 
+/* The order of global tags, also the one of binary tags files. Global tags don't
+ * have file/line information. */
+TMTagAttrType tm_tags_global_sort_attrs[] =
+{
+	tm_tag_attr_name_t,
+	tm_tag_attr_type_t, tm_tag_attr_scope_t, tm_tag_attr_arglist_t, 0
+};
+
+/* The string fields of all tags are interned: tags with an identical scope,
+ * type, etc. share a single copy of the string, which is freed when the last
+ * tag using it is destroyed. Maps the string to its reference count. */
+static GHashTable *tag_strings = NULL;
+G_LOCK_DEFINE_STATIC(tag_strings);
+
+
 typedef struct
 {
 	guint *sort_attrs;
@@ -82,6 +97,14 @@ typedef struct
 	gboolean first;
 } TMSortOptions;
 
+/* A tag with the first bytes of its name packed into an integer, so most
+ * comparisons during sorting don't need to dereference the tag */
+typedef struct
+{
+	guint64 key;
+	TMTag *tag;
+} TMSortEntry;
+
 /** Gets the GType for a TMTag.
  *
  * @return TMTag type
@@ -98,6 +121,76 @@ GType tm_tag_get_type(void)
 	return gtype;
 }
 
+/*
+ Returns the interned copy of a string to be stored in a TMTag field. Must be
+ released with tm_tag_release_string().
+ @param str The string to intern, or NULL.
+ @return The shared copy of the string, or NULL if str is NULL.
+*/
+gchar *tm_tag_intern_string(const gchar *str)
+{
+	gpointer interned, count;
+
+	if (!str)
+		return NULL;
+
+	G_LOCK(tag_strings);
+	/* the table has no key destroy function: inserting an existing key would
+	 * free it, the key is freed when its last reference is released instead */
+	if (!tag_strings)
+		tag_strings = g_hash_table_new(g_str_hash, g_str_equal);
+
+	if (g_hash_table_lookup_extended(tag_strings, str, &interned, &count))
+		g_hash_table_insert(tag_strings, interned, GUINT_TO_POINTER(GPOINTER_TO_UINT(count) + 1));
+	else
+	{
+		interned = g_strdup(str);
+		g_hash_table_insert(tag_strings, interned, GUINT_TO_POINTER(1));
+	}
+	G_UNLOCK(tag_strings);
+
+	return interned;
+}
+
+/*
+ Drops a reference from a string returned by tm_tag_intern_string(). Strings
+ which were not interned, e.g. set on a tag's fields by plugins, are freed
+ like they were before the tag strings were interned.
+ @param str The interned string, or NULL.
+*/
+void tm_tag_release_string(gchar *str)
+{
+	gpointer interned, count;
+
+	if (!str)
+		return;
+
+	G_LOCK(tag_strings);
+	/* the lookup is by content, only a reference of the stored copy is dropped */
+	if (tag_strings && g_hash_table_lookup_extended(tag_strings, str, &interned, &count) &&
+		interned == str)
+	{
+		if (GPOINTER_TO_UINT(count) > 1)
+		{
+			g_hash_table_insert(tag_strings, str, GUINT_TO_POINTER(GPOINTER_TO_UINT(count) - 1));
+			str = NULL;
+		}
+		else
+			g_hash_table_remove(tag_strings, str);
+	}
+	G_UNLOCK(tag_strings);
+
+	/* the last reference or a string which wasn't interned */
+	g_free(str);
+}
+
+/* Interned strings are equal only when they are the same string; like in the
+ * comparisons below, NULL and empty strings are considered equal */
+static gboolean tag_strings_equal(const gchar *a, const gchar *b)
+{
+	return a == b || ((!a || !*a) && (!b || !*b));
+}
+
 /*
  Creates a new tag structure and returns a pointer to it.
  @return the new TMTag structure. This should be free()-ed using tm_tag_free()
@@ -119,11 +212,11 @@ TMTag *tm_tag_new(void)
 */
 static void tm_tag_destroy(TMTag *tag)
 {
-	g_free(tag->name);
-	g_free(tag->arglist);
-	g_free(tag->scope);
-	g_free(tag->inheritance);
-	g_free(tag->var_type);
+	tm_tag_release_string(tag->name);
+	tm_tag_release_string(tag->arglist);
+	tm_tag_release_string(tag->scope);
+	tm_tag_release_string(tag->inheritance);
+	tm_tag_release_string(tag->var_type);
 }
 
 
@@ -185,7 +278,7 @@ static gint tm_tag_compare(gconstpointer ptr1, gconstpointer ptr2, gpointer user
 			case tm_tag_attr_name_t:
 				if (sort_options->partial)
 					returnval = strncmp(FALLBACK(t1->name, ""), FALLBACK(t2->name, ""), strlen(FALLBACK(t1->name, "")));
-				else
+				else if (t1->name != t2->name)
 					returnval = strcmp(FALLBACK(t1->name, ""), FALLBACK(t2->name, ""));
 				break;
 			case tm_tag_attr_file_t:
@@ -198,9 +291,12 @@ static gint tm_tag_compare(gconstpointer ptr1, gconstpointer ptr2, gpointer user
 				returnval = t1->type - t2->type;
 				break;
 			case tm_tag_attr_scope_t:
-				returnval = strcmp(FALLBACK(t1->scope, ""), FALLBACK(t2->scope, ""));
+				if (t1->scope != t2->scope)
+					returnval = strcmp(FALLBACK(t1->scope, ""), FALLBACK(t2->scope, ""));
 				break;
 			case tm_tag_attr_arglist_t:
+				if (t1->arglist == t2->arglist)
+					break;
 				returnval = strcmp(FALLBACK(t1->arglist, ""), FALLBACK(t2->arglist, ""));
 				if (returnval != 0)
 				{
@@ -210,31 +306,87 @@ static gint tm_tag_compare(gconstpointer ptr1, gconstpointer ptr2, gpointer user
 				}
 				break;
 			case tm_tag_attr_vartype_t:
-				returnval = strcmp(FALLBACK(t1->var_type, ""), FALLBACK(t2->var_type, ""));
+				if (t1->var_type != t2->var_type)
+					returnval = strcmp(FALLBACK(t1->var_type, ""), FALLBACK(t2->var_type, ""));
 				break;
 		}
 	}
 	return returnval;
 }
 
+static gint sort_entry_compare(gconstpointer ptr1, gconstpointer ptr2, gpointer user_data)
+{
+	const TMSortEntry *e1 = ptr1;
+	const TMSortEntry *e2 = ptr2;
+
+	/* the keys are ordered like the names by strcmp() */
+	if (e1->key != e2->key)
+		return e1->key < e2->key ? -1 : 1;
+
+	return tm_tag_compare(&e1->tag, &e2->tag, user_data);
+}
+
+
+static guint64 get_sort_key(const gchar *name)
+{
+	guint64 key = 0;
+	guint i;
+
+	/* big endian so the keys compare like the unsigned characters in strcmp() */
+	for (i = 0; name && i < sizeof(key) && name[i]; i++)
+		key |= (guint64) (guchar) name[i] << (8 * (sizeof(key) - 1 - i));
+	return key;
+}
+
+
+/* Sorts the tags on sort attributes starting with the name, comparing precomputed
+ * name prefixes first. Returns FALSE when the array contains NULL tags. */
+static gboolean sort_with_keys(GPtrArray *tags_array, TMSortOptions *sort_options)
+{
+	TMSortEntry *entries = g_new(TMSortEntry, tags_array->len);
+	guint i;
+
+	for (i = 0; i < tags_array->len; i++)
+	{
+		TMTag *tag = tags_array->pdata[i];
+
+		if (!tag)
+		{
+			g_free(entries);
+			return FALSE;
+		}
+		entries[i].key = get_sort_key(tag->name);
+		entries[i].tag = tag;
+	}
+
+	g_qsort_with_data(entries, tags_array->len, sizeof(TMSortEntry), sort_entry_compare,
+		sort_options);
+
+	for (i = 0; i < tags_array->len; i++)
+		tags_array->pdata[i] = entries[i].tag;
+	g_free(entries);
+	return TRUE;
+}
+
 gboolean tm_tags_equal(const TMTag *a, const TMTag *b)
 {
 	if (a == b)
 		return TRUE;
 
+	/* all string fields are interned, compare them by identity */
 	return (a->line == b->line &&
 			a->file == b->file /* ptr comparison */ &&
-			strcmp(FALLBACK(a->name, ""), FALLBACK(b->name, "")) == 0 &&
+			tag_strings_equal(a->name, b->name) &&
 			a->type == b->type &&
 			a->local == b->local &&
 			a->pointerOrder == b->pointerOrder &&
 			a->access == b->access &&
 			a->impl == b->impl &&
 			a->lang == b->lang &&
-			strcmp(FALLBACK(a->scope, ""), FALLBACK(b->scope, "")) == 0 &&
-			strcmp(FALLBACK(a->arglist, ""), FALLBACK(b->arglist, "")) == 0 &&
-			strcmp(FALLBACK(a->inheritance, ""), FALLBACK(b->inheritance, "")) == 0 &&
-			strcmp(FALLBACK(a->var_type, ""), FALLBACK(b->var_type, "")) == 0);
+			tag_strings_equal(a->scope, b->scope) &&
+			tag_strings_equal(a->arglist, b->arglist) &&
+			tag_strings_equal(a->inheritance, b->inheritance) &&
+			tag_strings_equal(a->var_type, b->var_type));
 }
 
 /*
@@ -302,7 +454,11 @@ void tm_tags_sort(GPtrArray *tags_array, TMTagAttrType *sort_attributes,
 
 	sort_options.sort_attrs = sort_attributes;
 	sort_options.partial = FALSE;
-	g_ptr_array_sort_with_data(tags_array, tm_tag_compare, &sort_options);
+	/* sort attributes starting with the name first compare precomputed name
+	 * prefixes, the rest of the comparison is tm_tag_compare() on ties */
+	if (!sort_attributes || sort_attributes[0] != tm_tag_attr_name_t ||
+		!sort_with_keys(tags_array, &sort_options))
+		g_ptr_array_sort_with_data(tags_array, tm_tag_compare, &sort_options);
 	if (dedup)
 		tm_tags_dedup(tags_array, sort_attributes, unref_duplicates);
 }
@@ -371,6 +527,115 @@ void tm_tags_remove_file_tags(TMSourceFile *source_file, GPtrArray *tags_array)
 	tm_tags_prune(tags_array);
 }
 
+/*
+ Removes the given tags from tags_array. Unlike tm_tags_remove_file_tags(), only
+ the listed tags are removed, not all tags of their files.
+ @param tags_array The array to remove the tags from.
+ @param removed The tags to remove.
+*/
+void tm_tags_remove_tags(GPtrArray *tags_array, GPtrArray *removed)
+{
+	guint i;
+
+	if (removed->len == 0)
+		return;
+
+	/* like in tm_tags_remove_file_tags(), choose between a linear scan and
+	 * binary searches of the removed tags */
+	if (tags_array->len / removed->len < 20)
+	{
+		GHashTable *removed_set = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+		for (i = 0; i < removed->len; i++)
+			g_hash_table_insert(removed_set, removed->pdata[i], removed->pdata[i]);
+
+		for (i = 0; i < tags_array->len; i++)
+		{
+			if (g_hash_table_lookup(removed_set, tags_array->pdata[i]))
+				tags_array->pdata[i] = NULL;
+		}
+		g_hash_table_destroy(removed_set);
+	}
+	else
+	{
+		GPtrArray *to_delete = g_ptr_array_sized_new(removed->len);
+
+		for (i = 0; i < removed->len; i++)
+		{
+			guint j;
+			guint tag_count;
+			TMTag **found;
+			TMTag *tag = removed->pdata[i];
+
+			found = tm_tags_find(tags_array, tag->name, FALSE, &tag_count);
+
+			for (j = 0; j < tag_count; j++)
+			{
+				if (*found == tag)
+				{
+					/* we cannot set the pointer to NULL now because the search wouldn't work */
+					g_ptr_array_add(to_delete, found);
+					break;
+				}
+				found++;
+			}
+		}
+
+		for (i = 0; i < to_delete->len; i++)
+		{
+			TMTag **tag = to_delete->pdata[i];
+			*tag = NULL;
+		}
+		g_ptr_array_free(to_delete, TRUE);
+	}
+
+	tm_tags_prune(tags_array);
+}
+
+/*
+ Compares the tags of a file before and after parsing it again. Tags which did
+ not change are replaced in new_tags by their previous instances so arrays
+ containing the previous tags don't have to be updated for them.
+ @param old_tags The tags before parsing, sorted on sort_attributes.
+ @param new_tags The tags after parsing, sorted on sort_attributes.
+ @param sort_attributes The attributes both arrays are sorted on.
+ @param added Array the tags of new_tags that are not in old_tags are added to.
+ @param removed Array the tags of old_tags that are not in new_tags are added to.
+*/
+void tm_tags_diff(GPtrArray *old_tags, GPtrArray *new_tags, TMTagAttrType *sort_attributes,
+	GPtrArray *added, GPtrArray *removed)
+{
+	TMSortOptions sort_options;
+	guint i = 0, j = 0;
+
+	sort_options.sort_attrs = sort_attributes;
+	sort_options.partial = FALSE;
+
+	while (i < old_tags->len && j < new_tags->len)
+	{
+		gint cmp = tm_tag_compare(&old_tags->pdata[i], &new_tags->pdata[j], &sort_options);
+
+		if (cmp < 0)
+			g_ptr_array_add(removed, old_tags->pdata[i++]);
+		else if (cmp > 0)
+			g_ptr_array_add(added, new_tags->pdata[j++]);
+		else if (tm_tags_equal(old_tags->pdata[i], new_tags->pdata[j]))
+		{
+			tm_tag_unref(new_tags->pdata[j]);
+			new_tags->pdata[j++] = tm_tag_ref(old_tags->pdata[i++]);
+		}
+		else
+		{
+			g_ptr_array_add(removed, old_tags->pdata[i++]);
+			g_ptr_array_add(added, new_tags->pdata[j++]);
+		}
+	}
+	for (; i < old_tags->len; i++)
+		g_ptr_array_add(removed, old_tags->pdata[i]);
+	for (; j < new_tags->len; j++)
+		g_ptr_array_add(added, new_tags->pdata[j]);
+}
+
 /* Optimized merge sort for merging sorted values from one array to another
  * where one of the arrays is much smaller than the other.
  * The merge complexity depends mostly on the size of the small array
@@ -110,10 +110,21 @@ GType tm_tag_get_type(void) G_GNUC_CONST;
 
 #ifdef GEANY_PRIVATE
 
+extern TMTagAttrType tm_tags_global_sort_attrs[];
+
 TMTag *tm_tag_new(void);
 
+gchar *tm_tag_intern_string(const gchar *str);
+
+void tm_tag_release_string(gchar *str);
+
 void tm_tags_remove_file_tags(TMSourceFile *source_file, GPtrArray *tags_array);
 
+void tm_tags_remove_tags(GPtrArray *tags_array, GPtrArray *removed);
+
+void tm_tags_diff(GPtrArray *old_tags, GPtrArray *new_tags, TMTagAttrType *sort_attributes,
+	GPtrArray *added, GPtrArray *removed);
+
 GPtrArray *tm_tags_merge(GPtrArray *big_array, GPtrArray *small_array, 
 	TMTagAttrType *sort_attributes, gboolean unref_duplicates);
 
@@ -36,7 +36,8 @@
 #include "tm_parser.h"
 
 
-/* when changing, always keep the three sort criteria below in sync */
+/* when changing, always keep the two sort criteria below and
+ * tm_tags_global_sort_attrs in sync */
 static TMTagAttrType workspace_tags_sort_attrs[] = 
 { 
 	tm_tag_attr_name_t, tm_tag_attr_file_t, tm_tag_attr_line_t,
@@ -50,13 +51,6 @@ static TMTagAttrType file_tags_sort_attrs[] =
 	tm_tag_attr_type_t, tm_tag_attr_scope_t, tm_tag_attr_arglist_t, 0
 };
 
-/* global tags don't have file/line information */
-static TMTagAttrType global_tags_sort_attrs[] =
-{
-	tm_tag_attr_name_t, 
-	tm_tag_attr_type_t, tm_tag_attr_scope_t, tm_tag_attr_arglist_t, 0
-};
-
 static TMTagType TM_TYPE_WITH_MEMBERS =
 	tm_tag_class_t | tm_tag_struct_t | tm_tag_union_t |
 	tm_tag_enum_t | tm_tag_interface_t;
@@ -65,8 +59,93 @@ static TMTagType TM_GLOBAL_TYPE_MASK =
 	tm_tag_class_t | tm_tag_enum_t | tm_tag_interface_t |
 	tm_tag_struct_t | tm_tag_typedef_t | tm_tag_union_t | tm_tag_namespace_t;
 
+/* how many files tm_workspace_add_source_files() reads ahead of the parser */
+#define SOURCE_FILE_LOAD_AHEAD 16
+
+typedef struct
+{
+	TMSourceFile *source_file;
+	gchar *contents;
+	gsize length;
+	gboolean loaded;	/* contents were read into memory */
+	gboolean done;		/* the loader thread finished with this file */
+} SourceFileLoad;
+
+/* Unique tag name in the completion index */
+typedef struct
+{
+	gchar *name;	/* interned tag name */
+	guint count;	/* number of workspace and global tags with the name */
+} CompletionEntry;
+
+/* Names of the type tags of one language used for syntax highlighting */
+typedef struct
+{
+	GHashTable *names;	/* interned name -> number of type tags with the name */
+	guint serial;		/* changes whenever a name is added or removed */
+} TypenameSet;
+
+/* The arrays of a TagPartition */
+enum
+{
+	PARTITION_TAGS,				/* like tags_array */
+	PARTITION_TYPENAMES,		/* like typename_array */
+	PARTITION_GLOBAL_TAGS,		/* like global_tags */
+	PARTITION_GLOBAL_TYPENAMES,	/* like global_typename_array */
+	PARTITION_COUNT
+};
+
+/* The workspace tags of compatible languages, sorted like the workspace arrays
+ * they are taken from. The combined arrays are public API (plugins and the
+ * sidebar read them), so they are kept as well; the partitions only hold
+ * pointers to the same tags and spare lookups for one language from searching
+ * and filtering the tags of all the others. */
+typedef struct
+{
+	GPtrArray *arrays[PARTITION_COUNT];
+} TagPartition;
+
 static TMWorkspace *theWorkspace = NULL;
 
+/* Maps the language (see get_index_lang()) to a GSequence of CompletionEntry
+ * sorted by name, maintained on every merge and removal of tags */
+static GHashTable *completion_index = NULL;
+
+/* Map the language (see get_index_lang()) to a hash table mapping scopes to the
+ * GPtrArray of tags with the scope, for tags_array and global_tags respectively */
+static GHashTable *workspace_scope_index = NULL;
+static GHashTable *global_scope_index = NULL;
+
+/* Maps the language (see get_index_lang()) to the TypenameSet of the workspace tags */
+static GHashTable *typename_index = NULL;
+static guint typename_serial = 0;
+
+/* Maps the language (see get_index_lang()) to its TagPartition */
+static GHashTable *tag_partitions = NULL;
+
+static GMutex source_file_load_mutex;
+static GCond source_file_load_cond;
+
+
+static void typename_set_free(gpointer data)
+{
+	TypenameSet *set = data;
+
+	g_hash_table_destroy(set->names);
+	g_slice_free(TypenameSet, set);
+}
+
+
+static void tag_partition_free(gpointer data)
+{
+	TagPartition *partition = data;
+	guint i;
+
+	for (i = 0; i < PARTITION_COUNT; i++)
+		g_ptr_array_free(partition->arrays[i], TRUE);
+	g_slice_free(TagPartition, partition);
+}
+
 
 static gboolean tm_create_workspace(void)
 {
@@ -78,6 +157,17 @@ static gboolean tm_create_workspace(void)
 	theWorkspace->typename_array = g_ptr_array_new();
 	theWorkspace->global_typename_array = g_ptr_array_new();
 
+	completion_index = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+		(GDestroyNotify) g_sequence_free);
+	workspace_scope_index = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+		(GDestroyNotify) g_hash_table_destroy);
+	global_scope_index = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+		(GDestroyNotify) g_hash_table_destroy);
+	typename_index = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+		typename_set_free);
+	tag_partitions = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+		tag_partition_free);
+
 	tm_ctags_init();
 	tm_parser_verify_type_mappings();
 
@@ -85,6 +175,293 @@ static gboolean tm_create_workspace(void)
 }
 
 
+/* C and C++ tags are compatible with each other and share the entries of the
+ * indexes, see tm_tag_langs_compatible() */
+static TMParserType get_index_lang(TMParserType lang)
+{
+	return lang == TM_PARSER_CPP ? TM_PARSER_C : lang;
+}
+
+
+static gint completion_entry_cmp(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	return strcmp(((const CompletionEntry *) a)->name, ((const CompletionEntry *) b)->name);
+}
+
+
+static void completion_entry_free(gpointer data)
+{
+	CompletionEntry *entry = data;
+
+	tm_tag_release_string(entry->name);
+	g_slice_free(CompletionEntry, entry);
+}
+
+
+/* Returns the entry with the given name, or the first entry sorted after it */
+static GSequenceIter *find_completion_entry(GSequence *names, const gchar *name)
+{
+	CompletionEntry key = { (gchar *) name, 0 };
+	/* g_sequence_search() returns the position after the equal entry */
+	GSequenceIter *iter = g_sequence_search(names, &key, completion_entry_cmp, NULL);
+
+	if (!g_sequence_iter_is_begin(iter))
+	{
+		GSequenceIter *prev = g_sequence_iter_prev(iter);
+		CompletionEntry *entry = g_sequence_get(prev);
+
+		if (strcmp(entry->name, name) == 0)
+			return prev;
+	}
+	return iter;
+}
+
+
+/* Adds the names of the tags to the completion index or removes them from it */
+static void update_completion_index(const GPtrArray *tags, gboolean add)
+{
+	CompletionEntry *last = NULL;
+	TMParserType last_lang = TM_PARSER_NONE;
+	guint i;
+
+	for (i = 0; i < tags->len; i++)
+	{
+		const TMTag *tag = tags->pdata[i];
+		TMParserType lang = get_index_lang(tag->lang);
+		GSequence *names;
+		GSequenceIter *iter;
+		CompletionEntry *entry = NULL;
+
+		if (!tag->name || lang == TM_PARSER_NONE)
+			continue;
+
+		/* the tags are mostly sorted by name, avoid searching for repeated names */
+		if (add && last && lang == last_lang && strcmp(last->name, tag->name) == 0)
+		{
+			last->count++;
+			continue;
+		}
+
+		names = g_hash_table_lookup(completion_index, GINT_TO_POINTER(lang));
+		if (!names)
+		{
+			if (!add)
+				continue;
+			names = g_sequence_new(completion_entry_free);
+			g_hash_table_insert(completion_index, GINT_TO_POINTER(lang), names);
+		}
+
+		iter = find_completion_entry(names, tag->name);
+		if (!g_sequence_iter_is_end(iter))
+		{
+			entry = g_sequence_get(iter);
+			if (strcmp(entry->name, tag->name) != 0)
+				entry = NULL;
+		}
+
+		if (!add)
+		{
+			if (entry && --entry->count == 0)
+				g_sequence_remove(iter);
+			continue;
+		}
+
+		if (entry)
+			entry->count++;
+		else
+		{
+			entry = g_slice_new(CompletionEntry);
+			entry->name = tm_tag_intern_string(tag->name);
+			entry->count = 1;
+			g_sequence_insert_before(iter, entry);
+		}
+		last = entry;
+		last_lang = lang;
+	}
+}
+
+
+static void scope_members_free(gpointer data)
+{
+	g_ptr_array_free(data, TRUE);
+}
+
+
+/* Adds the tags with a scope to the members of their scope in the index */
+static void add_scope_members(GHashTable *index, const GPtrArray *tags)
+{
+	guint i;
+
+	for (i = 0; i < tags->len; i++)
+	{
+		TMTag *tag = tags->pdata[i];
+		TMParserType lang = get_index_lang(tag->lang);
+		GHashTable *scopes;
+		GPtrArray *members;
+
+		if (!tag->scope || !tag->scope[0] || lang == TM_PARSER_NONE)
+			continue;
+
+		scopes = g_hash_table_lookup(index, GINT_TO_POINTER(lang));
+		if (!scopes)
+		{
+			scopes = g_hash_table_new_full(g_str_hash, g_str_equal,
+				(GDestroyNotify) tm_tag_release_string, scope_members_free);
+			g_hash_table_insert(index, GINT_TO_POINTER(lang), scopes);
+		}
+
+		members = g_hash_table_lookup(scopes, tag->scope);
+		if (!members)
+		{
+			members = g_ptr_array_new();
+			g_hash_table_insert(scopes, tm_tag_intern_string(tag->scope), members);
+		}
+		g_ptr_array_add(members, tag);
+	}
+}
+
+
+/* Removes the tags from the scopes of the index */
+static void remove_scope_members(GHashTable *index, const GPtrArray *tags)
+{
+	GHashTable *removed = g_hash_table_new(g_direct_hash, g_direct_equal);
+	GHashTable *visited = g_hash_table_new(g_direct_hash, g_direct_equal);
+	guint i;
+
+	for (i = 0; i < tags->len; i++)
+		g_hash_table_insert(removed, tags->pdata[i], tags->pdata[i]);
+
+	for (i = 0; i < tags->len; i++)
+	{
+		TMTag *tag = tags->pdata[i];
+		GHashTable *scopes;
+		GPtrArray *members;
+		guint j;
+
+		if (!tag->scope || !tag->scope[0])
+			continue;
+
+		scopes = g_hash_table_lookup(index, GINT_TO_POINTER(get_index_lang(tag->lang)));
+		members = scopes ? g_hash_table_lookup(scopes, tag->scope) : NULL;
+		/* the removed members of the scope were removed already */
+		if (!members || g_hash_table_lookup(visited, members))
+			continue;
+		g_hash_table_insert(visited, members, members);
+
+		for (j = 0; j < members->len; )
+		{
+			if (g_hash_table_lookup(removed, members->pdata[j]))
+				g_ptr_array_remove_index_fast(members, j);
+			else
+				j++;
+		}
+
+		if (members->len == 0)
+			g_hash_table_remove(scopes, tag->scope);
+	}
+
+	g_hash_table_destroy(visited);
+	g_hash_table_destroy(removed);
+}
+
+
+/* Adds the names of the type tags to the typename sets or removes them from them */
+static void update_typename_index(const GPtrArray *tags, gboolean add)
+{
+	guint i;
+
+	for (i = 0; i < tags->len; i++)
+	{
+		TMTag *tag = tags->pdata[i];
+		TMParserType lang = get_index_lang(tag->lang);
+		TypenameSet *set;
+		guint count;
+
+		if (!(tag->type & TM_GLOBAL_TYPE_MASK) || !tag->name || lang == TM_PARSER_NONE)
+			continue;
+
+		set = g_hash_table_lookup(typename_index, GINT_TO_POINTER(lang));
+		if (!set)
+		{
+			if (!add)
+				continue;
+			set = g_slice_new(TypenameSet);
+			set->names = g_hash_table_new_full(g_str_hash, g_str_equal,
+				(GDestroyNotify) tm_tag_release_string, NULL);
+			set->serial = ++typename_serial;
+			g_hash_table_insert(typename_index, GINT_TO_POINTER(lang), set);
+		}
+
+		count = GPOINTER_TO_UINT(g_hash_table_lookup(set->names, tag->name));
+		if (!add && count == 0)
+			continue;
+		if (add)
+			count++;
+		else
+			count--;
+
+		if (count == 0)
+			g_hash_table_remove(set->names, tag->name);
+		else
+		{
+			/* the table keeps a single reference of the name, the one of an
+			 * existing key is released again by the table */
+			g_hash_table_insert(set->names, tm_tag_intern_string(tag->name),
+				GUINT_TO_POINTER(count));
+		}
+
+		if (count == 0 || (add && count == 1))
+			set->serial = ++typename_serial;
+	}
+}
+
+
+/* Returns the partition of the tags compatible with lang, NULL for TM_PARSER_NONE */
+static TagPartition *get_tag_partition(TMParserType lang, gboolean create)
+{
+	TagPartition *partition;
+
+	lang = get_index_lang(lang);
+	if (lang == TM_PARSER_NONE)
+		return NULL;
+
+	partition = g_hash_table_lookup(tag_partitions, GINT_TO_POINTER(lang));
+	if (!partition && create)
+	{
+		guint i;
+
+		partition = g_slice_new(TagPartition);
+		for (i = 0; i < PARTITION_COUNT; i++)
+			partition->arrays[i] = g_ptr_array_new();
+		g_hash_table_insert(tag_partitions, GINT_TO_POINTER(lang), partition);
+	}
+	return partition;
+}
+
+
+/* Replaces the given array of all partitions with the tags of the sorted array,
+ * which keeps the partitions sorted */
+static void split_tags(const GPtrArray *tags, guint array)
+{
+	GHashTableIter iter;
+	gpointer value;
+	guint i;
+
+	g_hash_table_iter_init(&iter, tag_partitions);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		g_ptr_array_set_size(((TagPartition *) value)->arrays[array], 0);
+
+	for (i = 0; i < tags->len; i++)
+	{
+		TMTag *tag = tags->pdata[i];
+		TagPartition *partition = get_tag_partition(tag->lang, TRUE);
+
+		if (partition)
+			g_ptr_array_add(partition->arrays[array], tag);
+	}
+}
+
+
 /* Frees the workspace structure and all child source files. Use only when
  exiting from the main program.
 */
@@ -103,6 +480,16 @@ void tm_workspace_free(void)
 	g_ptr_array_free(theWorkspace->tags_array, TRUE);
 	g_ptr_array_free(theWorkspace->typename_array, TRUE);
 	g_ptr_array_free(theWorkspace->global_typename_array, TRUE);
+	g_hash_table_destroy(completion_index);
+	completion_index = NULL;
+	g_hash_table_destroy(workspace_scope_index);
+	workspace_scope_index = NULL;
+	g_hash_table_destroy(global_scope_index);
+	global_scope_index = NULL;
+	g_hash_table_destroy(typename_index);
+	typename_index = NULL;
+	g_hash_table_destroy(tag_partitions);
+	tag_partitions = NULL;
 	g_free(theWorkspace);
 	theWorkspace = NULL;
 }
@@ -141,30 +528,105 @@ static void merge_extracted_tags(GPtrArray **dest, GPtrArray *src, TMTagType tag
 }
 
 
-static void update_source_file(TMSourceFile *source_file, guchar* text_buf,
-	gsize buf_size, gboolean use_buffer, gboolean update_workspace)
+/* Removes tags of source_file from the workspace arrays and indexes, all of them
+ * when tags is the tags_array of the file */
+static void remove_workspace_tags(TMSourceFile *source_file, GPtrArray *tags)
 {
+	TagPartition *partition = get_tag_partition(source_file->lang, FALSE);
+
+	if (tags->len == 0)
+		return;
+
+	if (tags == source_file->tags_array)
+	{
+		tm_tags_remove_file_tags(source_file, theWorkspace->tags_array);
+		tm_tags_remove_file_tags(source_file, theWorkspace->typename_array);
+		if (partition)
+		{
+			tm_tags_remove_file_tags(source_file, partition->arrays[PARTITION_TAGS]);
+			tm_tags_remove_file_tags(source_file, partition->arrays[PARTITION_TYPENAMES]);
+		}
+	}
+	else
+	{
+		tm_tags_remove_tags(theWorkspace->tags_array, tags);
+		tm_tags_remove_tags(theWorkspace->typename_array, tags);
+		if (partition)
+		{
+			tm_tags_remove_tags(partition->arrays[PARTITION_TAGS], tags);
+			tm_tags_remove_tags(partition->arrays[PARTITION_TYPENAMES], tags);
+		}
+	}
+	update_completion_index(tags, FALSE);
+	remove_scope_members(workspace_scope_index, tags);
+	update_typename_index(tags, FALSE);
+}
+
+
+/* Adds tags of source_file sorted like its tags_array to the workspace arrays and indexes */
+static void add_workspace_tags(TMSourceFile *source_file, GPtrArray *tags)
+{
+	TagPartition *partition;
+
+	if (tags->len == 0)
+		return;
+
+	tm_workspace_merge_tags(&theWorkspace->tags_array, tags);
+	merge_extracted_tags(&(theWorkspace->typename_array), tags, TM_GLOBAL_TYPE_MASK);
+
+	partition = get_tag_partition(source_file->lang, TRUE);
+	if (partition)
+	{
+		tm_workspace_merge_tags(&partition->arrays[PARTITION_TAGS], tags);
+		merge_extracted_tags(&partition->arrays[PARTITION_TYPENAMES], tags, TM_GLOBAL_TYPE_MASK);
+	}
+	update_completion_index(tags, TRUE);
+	add_scope_members(workspace_scope_index, tags);
+	update_typename_index(tags, TRUE);
+}
+
+
+/* Parses the source file and updates the workspace with the tags that changed.
+ * Returns whether the tags of the file changed. */
+static gboolean update_source_file(TMSourceFile *source_file, guchar* text_buf,
+	gsize buf_size, guchar *tail_buf, gsize tail_size, gboolean use_buffer,
+	gboolean update_workspace)
+{
+	GPtrArray *old_tags = NULL;
+	gboolean changed = TRUE;
+	guint i;
+
 #ifdef TM_DEBUG
 	g_message("Source file updating based on source file %s", source_file->file_name);
 #endif
 
 	if (update_workspace)
 	{
-		/* tm_source_file_parse() deletes the tag objects - remove the tags from
-		 * workspace while they exist and can be scanned */
-		tm_tags_remove_file_tags(source_file, theWorkspace->tags_array);
-		tm_tags_remove_file_tags(source_file, theWorkspace->typename_array);
+		/* tm_source_file_parse() deletes the tag objects - keep them alive to
+		 * compare them with the new tags */
+		old_tags = g_ptr_array_sized_new(source_file->tags_array->len);
+		for (i = 0; i < source_file->tags_array->len; i++)
+			g_ptr_array_add(old_tags, tm_tag_ref(source_file->tags_array->pdata[i]));
 	}
-	tm_source_file_parse(source_file, text_buf, buf_size, use_buffer);
+	tm_source_file_parse(source_file, text_buf, buf_size, tail_buf, tail_size, use_buffer);
 	tm_tags_sort(source_file->tags_array, file_tags_sort_attrs, FALSE, TRUE);
 	if (update_workspace)
 	{
+		GPtrArray *added = g_ptr_array_new();
+		GPtrArray *removed = g_ptr_array_new();
+
 #ifdef TM_DEBUG
 		g_message("Updating workspace from source file");
 #endif
-		tm_workspace_merge_tags(&theWorkspace->tags_array, source_file->tags_array);
-
-		merge_extracted_tags(&(theWorkspace->typename_array), source_file->tags_array, TM_GLOBAL_TYPE_MASK);
+		/* unchanged tags stay in the workspace, only the differences are applied */
+		tm_tags_diff(old_tags, source_file->tags_array, file_tags_sort_attrs, added, removed);
+		remove_workspace_tags(source_file, removed);
+		add_workspace_tags(source_file, added);
+		changed = added->len > 0 || removed->len > 0;
+
+		g_ptr_array_free(added, TRUE);
+		g_ptr_array_free(removed, TRUE);
+		tm_tags_array_free(old_tags, TRUE);
 	}
 #ifdef TM_DEBUG
 	else
@@ -172,6 +634,7 @@ static void update_source_file(TMSourceFile *source_file, guchar* text_buf,
 			update_workspace?"TRUE":"FALSE");
 
 #endif
+	return changed;
 }
 
 
@@ -184,7 +647,7 @@ void tm_workspace_add_source_file(TMSourceFile *source_file)
 	g_return_if_fail(source_file != NULL);
 
 	g_ptr_array_add(theWorkspace->source_files, source_file);
-	update_source_file(source_file, NULL, 0, FALSE, TRUE);
+	update_source_file(source_file, NULL, 0, NULL, 0, FALSE, TRUE);
 }
 
 
@@ -200,18 +663,22 @@ void tm_workspace_add_source_file_noupdate(TMSourceFile *source_file)
  Ctags will use a parsing based on buffer instead of on files.
  You should call this function when you don't want a previous saving of the file
  you're editing. It's useful for a "real-time" updating of the tags.
- The tags array and the tags themselves are destroyed and re-created, hence any
- other tag arrays pointing to these tags should be rebuilt as well. All sorting
- information is also lost.
+ The tags array is re-created. Tags which didn't change keep their previous
+ objects, the other tags are destroyed and re-created, hence any other tag
+ arrays pointing to these tags should be rebuilt when the tags changed.
  @param source_file The source file to update with a buffer.
  @param text_buf A text buffer. The user should take care of allocate and free it after
  the use here.
  @param buf_size The size of text_buf.
+ @param tail_buf The text following text_buf when the text isn't contiguous in memory, or NULL.
+ Parsing the two parts of Scintilla's buffer around its gap avoids moving the gap.
+ @param tail_size The size of tail_buf.
+ @return TRUE if the tags of the file changed.
 */
-void tm_workspace_update_source_file_buffer(TMSourceFile *source_file, guchar* text_buf,
-	gsize buf_size)
+gboolean tm_workspace_update_source_file_buffer(TMSourceFile *source_file, guchar* text_buf,
+	gsize buf_size, guchar *tail_buf, gsize tail_size)
 {
-	update_source_file(source_file, text_buf, buf_size, TRUE, TRUE);
+	return update_source_file(source_file, text_buf, buf_size, tail_buf, tail_size, TRUE, TRUE);
 }
 
 
@@ -231,8 +698,7 @@ void tm_workspace_remove_source_file(TMSourceFile *source_file)
 	{
 		if (theWorkspace->source_files->pdata[i] == source_file)
 		{
-			tm_tags_remove_file_tags(source_file, theWorkspace->tags_array);
-			tm_tags_remove_file_tags(source_file, theWorkspace->typename_array);
+			remove_workspace_tags(source_file, source_file->tags_array);
 			g_ptr_array_remove_index_fast(theWorkspace->source_files, i);
 			return;
 		}
@@ -249,6 +715,8 @@ static void tm_workspace_update(void)
 {
 	guint i, j;
 	TMSourceFile *source_file;
+	GHashTableIter iter;
+	gpointer value;
 
 #ifdef TM_DEBUG
 	g_message("Recreating workspace tags array");
@@ -279,8 +747,117 @@ static void tm_workspace_update(void)
 #endif
 	tm_tags_sort(theWorkspace->tags_array, workspace_tags_sort_attrs, TRUE, FALSE);
 
+	g_hash_table_remove_all(completion_index);
+	update_completion_index(theWorkspace->global_tags, TRUE);
+	update_completion_index(theWorkspace->tags_array, TRUE);
+
+	g_hash_table_remove_all(workspace_scope_index);
+	add_scope_members(workspace_scope_index, theWorkspace->tags_array);
+
 	g_ptr_array_free(theWorkspace->typename_array, TRUE);
 	theWorkspace->typename_array = tm_tags_extract(theWorkspace->tags_array, TM_GLOBAL_TYPE_MASK);
+
+	g_hash_table_iter_init(&iter, typename_index);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		TypenameSet *set = value;
+
+		g_hash_table_remove_all(set->names);
+		set->serial = ++typename_serial;
+	}
+	update_typename_index(theWorkspace->typename_array, TRUE);
+
+	split_tags(theWorkspace->tags_array, PARTITION_TAGS);
+	split_tags(theWorkspace->typename_array, PARTITION_TYPENAMES);
+}
+
+
+/* Thread pool worker reading a source file into memory so the main thread can
+ * parse it from the buffer without waiting for the disk */
+static void load_source_file_contents(gpointer data, gpointer user_data)
+{
+	SourceFileLoad *load = data;
+	TMSourceFile *source_file = load->source_file;
+	GStatBuf s;
+
+	/* like tm_source_file_parse(), leave big files to be parsed from the disk */
+	if (source_file->file_name && source_file->lang != TM_PARSER_NONE &&
+		g_stat(source_file->file_name, &s) == 0 && s.st_size <= 10*1024*1024)
+	{
+		load->loaded = g_file_get_contents(source_file->file_name, &load->contents,
+			&load->length, NULL);
+	}
+
+	g_mutex_lock(&source_file_load_mutex);
+	load->done = TRUE;
+	g_cond_broadcast(&source_file_load_cond);
+	g_mutex_unlock(&source_file_load_mutex);
+}
+
+
+static gint get_loader_thread_count(void)
+{
+#if GLIB_CHECK_VERSION(2, 36, 0)
+	return CLAMP((gint) g_get_num_processors(), 2, 8);
+#else
+	return 4;
+#endif
+}
+
+
+/* Parses the given source files without updating the workspace. The files are
+ * read by a pool of worker threads a few files ahead of the parser; the ctags
+ * parsers keep their state in global variables so the parsing itself stays
+ * on the calling thread. With report_timings, the time spent on each file
+ * is logged as a debug message, which is shown by 'geany -v'. */
+static void parse_source_files(GPtrArray *source_files, gboolean report_timings)
+{
+	SourceFileLoad *loads = g_new0(SourceFileLoad, source_files->len);
+	GTimer *timer = g_timer_new();
+	GThreadPool *pool;
+	guint i;
+
+	pool = g_thread_pool_new(load_source_file_contents, NULL, get_loader_thread_count(),
+		FALSE, NULL);
+
+	for (i = 0; i < source_files->len; i++)
+	{
+		loads[i].source_file = source_files->pdata[i];
+		/* limit the amount of file contents held in memory at the same time */
+		if (i < SOURCE_FILE_LOAD_AHEAD)
+			g_thread_pool_push(pool, &loads[i], NULL);
+	}
+
+	for (i = 0; i < source_files->len; i++)
+	{
+		SourceFileLoad *load = &loads[i];
+
+		g_mutex_lock(&source_file_load_mutex);
+		while (!load->done)
+			g_cond_wait(&source_file_load_cond, &source_file_load_mutex);
+		g_mutex_unlock(&source_file_load_mutex);
+
+		if (i + SOURCE_FILE_LOAD_AHEAD < source_files->len)
+			g_thread_pool_push(pool, &loads[i + SOURCE_FILE_LOAD_AHEAD], NULL);
+
+		g_timer_start(timer);
+		if (load->loaded)
+		{
+			update_source_file(load->source_file, (guchar *) load->contents, load->length,
+				NULL, 0, TRUE, FALSE);
+			g_free(load->contents);
+		}
+		else
+			update_source_file(load->source_file, NULL, 0, NULL, 0, FALSE, FALSE);
+
+		if (report_timings)
+			g_debug("%s: %u tags in %.3f s", load->source_file->file_name,
+				load->source_file->tags_array->len, g_timer_elapsed(timer, NULL));
+	}
+
+	g_timer_destroy(timer);
+	g_thread_pool_free(pool, FALSE, TRUE);
+	g_free(loads);
 }
 
 
@@ -297,12 +874,9 @@ void tm_workspace_add_source_files(GPtrArray *source_files)
 	g_return_if_fail(source_files != NULL);
 
 	for (i = 0; i < source_files->len; i++)
-	{
-		TMSourceFile *source_file = source_files->pdata[i];
-		
-		tm_workspace_add_source_file_noupdate(source_file);
-		update_source_file(source_file, NULL, 0, FALSE, FALSE);
-	}
+		tm_workspace_add_source_file_noupdate(source_files->pdata[i]);
+
+	parse_source_files(source_files, FALSE);
 	
 	tm_workspace_update();
 }
@@ -349,23 +923,35 @@ void tm_workspace_remove_source_files(GPtrArray *source_files)
 gboolean tm_workspace_load_global_tags(const char *tags_file, TMParserType mode)
 {
 	GPtrArray *file_tags, *new_tags;
+	gboolean sorted;
 
-	file_tags = tm_source_file_read_tags_file(tags_file, mode);
+	file_tags = tm_source_file_read_tags_file(tags_file, mode, &sorted);
 	if (!file_tags)
 		return FALSE;
 
-	tm_tags_sort(file_tags, global_tags_sort_attrs, TRUE, TRUE);
+	/* binary tags files created by tm_workspace_create_global_tags() and sorted
+	 * ctags files without repeated names are sorted already */
+	if (!sorted)
+		tm_tags_sort(file_tags, tm_tags_global_sort_attrs, TRUE, TRUE);
+	update_completion_index(file_tags, TRUE);
 
 	/* reorder the whole array, because tm_tags_find expects a sorted array */
 	new_tags = tm_tags_merge(theWorkspace->global_tags, 
-		file_tags, global_tags_sort_attrs, TRUE);
+		file_tags, tm_tags_global_sort_attrs, TRUE);
 	g_ptr_array_free(theWorkspace->global_tags, TRUE);
 	g_ptr_array_free(file_tags, TRUE);
 	theWorkspace->global_tags = new_tags;
 
+	/* the merge frees duplicates of already loaded tags, index the merged array */
+	g_hash_table_remove_all(global_scope_index);
+	add_scope_members(global_scope_index, new_tags);
+
 	g_ptr_array_free(theWorkspace->global_typename_array, TRUE);
 	theWorkspace->global_typename_array = tm_tags_extract(new_tags, TM_GLOBAL_TYPE_MASK);
 
+	split_tags(new_tags, PARTITION_GLOBAL_TAGS);
+	split_tags(theWorkspace->global_typename_array, PARTITION_GLOBAL_TYPENAMES);
+
 	return TRUE;
 }
 
@@ -420,39 +1006,6 @@ static gboolean write_includes_file(const gchar *outf, GList *includes_files)
 }
 
 
-static gboolean combine_include_files(const gchar *outf, GList *file_list)
-{
-	FILE *fp = g_fopen(outf, "w");
-	GList *node = file_list;
-
-	if (!fp)
-		return FALSE;
-
-	while (node)
-	{
-		const char *fname = node->data;
-		char *contents;
-		size_t length;
-		GError *err = NULL;
-
-		if (! g_file_get_contents(fname, &contents, &length, &err))
-		{
-			fprintf(stderr, "Unable to read file: %s\n", err->message);
-			g_error_free(err);
-		}
-		else
-		{
-			fwrite(contents, length, 1, fp);
-			fwrite("\n", 1, 1, fp);	/* in case file doesn't end in newline (e.g. windows). */
-			g_free(contents);
-		}
-		node = g_list_next (node);
-	}
-
-	return fclose(fp) == 0;
-}
-
-
 static gchar *create_temp_file(const gchar *tpl)
 {
 	gchar *name;
@@ -590,72 +1143,132 @@ static gchar *pre_process_file(const gchar *cmd, const gchar *inf)
 	return outf;
 }
 
+
+/* Parses the include files one by one and writes their merged tags to tags_file */
+static gboolean create_global_tags_from_files(GList *includes_files, const char *tags_file,
+	TMParserType lang, gboolean text)
+{
+	const gchar *lang_name = tm_source_file_get_lang_name(lang);
+	GPtrArray *source_files = g_ptr_array_new();
+	GPtrArray *tags = g_ptr_array_new();
+	gboolean ret = FALSE;
+	GList *node;
+	guint i;
+
+	for (node = includes_files; node; node = node->next)
+	{
+		TMSourceFile *source_file = tm_source_file_new(node->data, lang_name);
+
+		if (source_file)
+			g_ptr_array_add(source_files, source_file);
+	}
+
+	parse_source_files(source_files, TRUE);
+
+	/* the tags stay owned by their source files, the array only points to them;
+	 * collect all of them, they are sorted once by the writer instead of being
+	 * merged file by file */
+	for (i = 0; i < source_files->len; i++)
+	{
+		TMSourceFile *source_file = source_files->pdata[i];
+		guint j;
+
+		for (j = 0; j < source_file->tags_array->len; j++)
+			g_ptr_array_add(tags, source_file->tags_array->pdata[j]);
+	}
+
+	if (tags->len > 0)
+		ret = tm_source_file_write_tags_file(tags_file, tags, text);
+
+	g_ptr_array_free(tags, TRUE);
+	for (i = 0; i < source_files->len; i++)
+		tm_source_file_free(source_files->pdata[i]);
+	g_ptr_array_free(source_files, TRUE);
+
+	return ret;
+}
+
+
 /* Creates a list of global tags. Ideally, this should be created once during
  installations so that all users can use the same file. This is because a full
  scale global tag list can occupy several megabytes of disk space.
  @param pre_process The pre-processing command. This is executed via system(),
  so you can pass stuff like 'gcc -E -dD -P `gnome-config --cflags gnome`'.
+ When NULL, the files are parsed one by one without being combined first.
  @param includes Include files to process. Wildcards such as '/usr/include/a*.h'
  are allowed.
  @param tags_file The file where the tags will be stored.
  @param lang The language to use for the tags file.
+ @param text Whether to write the tagmanager text format instead of the binary one.
  @return TRUE on success, FALSE on failure.
 */
 gboolean tm_workspace_create_global_tags(const char *pre_process, const char **includes,
-	int includes_count, const char *tags_file, TMParserType lang)
+	int includes_count, const char *tags_file, TMParserType lang, gboolean text)
 {
 	gboolean ret = FALSE;
 	TMSourceFile *source_file;
 	GList *includes_files;
-	gchar *temp_file = create_temp_file("tmp_XXXXXX.cpp");
+	gchar *temp_file, *temp_file2;
+	GTimer *timer = NULL;
 
+	includes_files = lookup_includes(includes, includes_count);
+
+	/* without preprocessing, the files don't have to be combined into one */
+	if (!pre_process)
+	{
+		ret = create_global_tags_from_files(includes_files, tags_file, lang, text);
+		g_list_free_full(includes_files, g_free);
+		return ret;
+	}
+
+	temp_file = create_temp_file("tmp_XXXXXX.cpp");
 	if (!temp_file)
+	{
+		g_list_free_full(includes_files, g_free);
 		return FALSE;
-
-	includes_files = lookup_includes(includes, includes_count);
+	}
 
 #ifdef TM_DEBUG
 	g_message ("writing out files to %s\n", temp_file);
 #endif
-	if (pre_process)
-		ret = write_includes_file(temp_file, includes_files);
-	else
-		ret = combine_include_files(temp_file, includes_files);
+	ret = write_includes_file(temp_file, includes_files);
 
 	g_list_free_full(includes_files, g_free);
 	if (!ret)
 		goto cleanup;
 	ret = FALSE;
 
-	if (pre_process)
-	{
-		gchar *temp_file2 = pre_process_file(pre_process, temp_file);
-
-		if (temp_file2)
-		{
-			g_unlink(temp_file);
-			g_free(temp_file);
-			temp_file = temp_file2;
-		}
-		else
-			goto cleanup;
-	}
+	/* the include files are preprocessed together: preprocessing them one by
+	 * one would expand the headers they share into every output, multiplying
+	 * the text the parser, which can't run in parallel, has to go through */
+	timer = g_timer_new();
+	temp_file2 = pre_process_file(pre_process, temp_file);
+	g_debug("preprocessing: %.3f s", g_timer_elapsed(timer, NULL));
+	if (!temp_file2)
+		goto cleanup;
+	g_unlink(temp_file);
+	g_free(temp_file);
+	temp_file = temp_file2;
 
 	source_file = tm_source_file_new(temp_file, tm_source_file_get_lang_name(lang));
 	if (!source_file)
 		goto cleanup;
-	update_source_file(source_file, NULL, 0, FALSE, FALSE);
+	g_timer_start(timer);
+	update_source_file(source_file, NULL, 0, NULL, 0, FALSE, FALSE);
+	g_debug("parsing: %u tags in %.3f s", source_file->tags_array->len,
+		g_timer_elapsed(timer, NULL));
 	if (source_file->tags_array->len == 0)
 	{
 		tm_source_file_free(source_file);
 		goto cleanup;
 	}
 
-	tm_tags_sort(source_file->tags_array, global_tags_sort_attrs, TRUE, FALSE);
-	ret = tm_source_file_write_tags_file(tags_file, source_file->tags_array);
+	ret = tm_source_file_write_tags_file(tags_file, source_file->tags_array, text);
 	tm_source_file_free(source_file);
 
 cleanup:
+	if (timer)
+		g_timer_destroy(timer);
 	g_unlink(temp_file);
 	g_free(temp_file);
 	return ret;
@@ -671,6 +1284,17 @@ static void fill_find_tags_array(GPtrArray *dst, const GPtrArray *src,
 	if (!src || !dst || !name || !*name)
 		return;
 
+	/* only search the workspace tags of compatible languages */
+	if (src == theWorkspace->tags_array || src == theWorkspace->global_tags)
+	{
+		TagPartition *partition = get_tag_partition(lang, FALSE);
+
+		if (!partition)
+			return;
+		src = partition->arrays[src == theWorkspace->tags_array ?
+			PARTITION_TAGS : PARTITION_GLOBAL_TAGS];
+	}
+
 	tag = tm_tags_find(src, name, FALSE, &num);
 	for (i = 0; i < num; ++i)
 	{
@@ -709,34 +1333,55 @@ GPtrArray *tm_workspace_find(const char *name, const char *scope, TMTagType type
 }
 
 
-static void fill_find_tags_array_prefix(GPtrArray *dst, const GPtrArray *src,
-	const char *name, TMParserType lang, guint max_num)
+/* Returns the first tag with the given name suitable for completion from a
+ * partition array, whose tags are all of compatible languages */
+static TMTag *find_completion_tag(const GPtrArray *tags, const gchar *name)
 {
-	TMTag **tag, *last = NULL;
-	guint i, count, num;
-
-	if (!src || !dst || !name || !*name)
-		return;
+	TMTag **tag;
+	guint i, num;
 
-	num = 0;
-	tag = tm_tags_find(src, name, TRUE, &count);
-	for (i = 0; i < count && num < max_num; ++i)
+	tag = tm_tags_find(tags, name, FALSE, &num);
+	for (i = 0; i < num; i++)
 	{
-		if (tm_tag_langs_compatible(lang, (*tag)->lang) &&
-			!tm_tag_is_anon(*tag) &&
-			(!last || g_strcmp0(last->name, (*tag)->name) != 0))
-		{
-			g_ptr_array_add(dst, *tag);
-			last = *tag;
-			num++;
-		}
-		tag++;
+		if (!tm_tag_is_anon(tag[i]))
+			return tag[i];
 	}
+	return NULL;
+}
+
+
+/* Returns the typenames of the languages compatible with lang, sorted by name.
+ @param lang The language of the typenames.
+ @param global Whether to return the typenames of the global tags instead of the
+ workspace tags.
+ @return The typename tags, NULL when there are none. */
+const GPtrArray *tm_workspace_get_typenames(TMParserType lang, gboolean global)
+{
+	TagPartition *partition = get_tag_partition(lang, FALSE);
+
+	if (!partition)
+		return NULL;
+	return partition->arrays[global ? PARTITION_GLOBAL_TYPENAMES : PARTITION_TYPENAMES];
+}
+
+
+/* Returns a number identifying the current set of the workspace typenames of the
+ language. It changes whenever a typename is added or removed so the typenames
+ used for highlighting only have to be collected again when it changes.
+ @param lang The language of the typenames.
+ @return The serial of the typenames, 0 when there are none. */
+guint tm_workspace_get_typename_serial(TMParserType lang)
+{
+	TypenameSet *set = g_hash_table_lookup(typename_index, GINT_TO_POINTER(get_index_lang(lang)));
+
+	return set ? set->serial : 0;
 }
 
 
 /* Returns tags with the specified prefix sorted by name. If there are several
  tags with the same name, only one of them appears in the resulting array.
+ The unique names come from the completion index so only the returned names
+ are visited.
  @param prefix The prefix of the tag to find.
  @param lang Specifies the language(see the table in parsers.h) of the tags to be found,
              -1 for all.
@@ -745,15 +1390,39 @@ static void fill_find_tags_array_prefix(GPtrArray *dst, const GPtrArray *src,
 */
 GPtrArray *tm_workspace_find_prefix(const char *prefix, TMParserType lang, guint max_num)
 {
-	TMTagAttrType attrs[] = { tm_tag_attr_name_t, 0 };
 	GPtrArray *tags = g_ptr_array_new();
+	TagPartition *partition;
+	GSequence *names;
+	GSequenceIter *iter;
+	gsize prefix_len;
+
+	if (!prefix || !*prefix)
+		return tags;
+
+	names = g_hash_table_lookup(completion_index, GINT_TO_POINTER(get_index_lang(lang)));
+	partition = get_tag_partition(lang, FALSE);
+	if (!names || !partition)
+		return tags;
+
+	prefix_len = strlen(prefix);
+	for (iter = find_completion_entry(names, prefix);
+		 !g_sequence_iter_is_end(iter) && tags->len < max_num;
+		 iter = g_sequence_iter_next(iter))
+	{
+		CompletionEntry *entry = g_sequence_get(iter);
+		TMTag *tag;
 
-	fill_find_tags_array_prefix(tags, theWorkspace->tags_array, prefix, lang, max_num);
-	fill_find_tags_array_prefix(tags, theWorkspace->global_tags, prefix, lang, max_num);
+		if (strncmp(entry->name, prefix, prefix_len) != 0)
+			break;
 
-	tm_tags_sort(tags, attrs, TRUE, FALSE);
-	if (tags->len > max_num)
-		tags->len = max_num;
+		/* prefer workspace tags like tm_workspace_find() */
+		tag = find_completion_tag(partition->arrays[PARTITION_TAGS], entry->name);
+		if (!tag)
+			tag = find_completion_tag(partition->arrays[PARTITION_GLOBAL_TAGS], entry->name);
+		/* NULL when the name belongs to anonymous tags only */
+		if (tag)
+			g_ptr_array_add(tags, tag);
+	}
 
 	return tags;
 }
@@ -770,7 +1439,9 @@ static GPtrArray *
 find_scope_members_tags (const GPtrArray *all, TMTag *type_tag, gboolean namespace)
 {
 	TMTagType member_types = tm_tag_max_t & ~(TM_TYPE_WITH_MEMBERS | tm_tag_typedef_t);
+	TMTagAttrType sort_attrs[] = { tm_tag_attr_name_t, 0 };
 	GPtrArray *tags = g_ptr_array_new();
+	gboolean indexed = FALSE;
 	gchar *scope;
 	guint i;
 
@@ -782,7 +1453,21 @@ find_scope_members_tags (const GPtrArray *all, TMTag *type_tag, gboolean namespa
 	else
 		scope = g_strdup(type_tag->name);
 
-	for (i = 0; i < all->len; ++i)
+	/* the workspace and global tags are looked up in the scope index, only the
+	 * tags of single source files are scanned */
+	if (all == theWorkspace->tags_array || all == theWorkspace->global_tags)
+	{
+		GHashTable *index = all == theWorkspace->tags_array ?
+			workspace_scope_index : global_scope_index;
+		GHashTable *scopes = g_hash_table_lookup(index,
+			GINT_TO_POINTER(get_index_lang(type_tag->lang)));
+		GPtrArray *members = scopes ? g_hash_table_lookup(scopes, scope) : NULL;
+
+		all = members;
+		indexed = TRUE;
+	}
+
+	for (i = 0; all && i < all->len; ++i)
 	{
 		TMTag *tag = TM_TAG (all->pdata[i]);
 
@@ -804,6 +1489,11 @@ find_scope_members_tags (const GPtrArray *all, TMTag *type_tag, gboolean namespa
 		return NULL;
 	}
 
+	/* the members of an index entry are unordered - sort them by name like the
+	 * scanned arrays */
+	if (indexed)
+		tm_tags_sort(tags, sort_attrs, FALSE, FALSE);
+
 	return tags;
 }
 
@@ -1085,6 +1775,8 @@ tm_workspace_find_scope_members (TMSourceFile *source_file, const char *name,
 /* Dumps the workspace tree - useful for debugging */
 void tm_workspace_dump(void)
 {
+	GHashTableIter iter;
+	gpointer key, value;
 	guint i;
 
 #ifdef TM_DEBUG
@@ -1095,6 +1787,19 @@ void tm_workspace_dump(void)
 		TMSourceFile *source_file = theWorkspace->source_files->pdata[i];
 		fprintf(stderr, "%s", source_file->file_name);
 	}
+
+	g_hash_table_iter_init(&iter, tag_partitions);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+	{
+		TagPartition *partition = value;
+
+		fprintf(stderr, "%s: %u tags, %u typenames, %u global tags, %u global typenames\n",
+			tm_source_file_get_lang_name(GPOINTER_TO_INT(key)),
+			partition->arrays[PARTITION_TAGS]->len,
+			partition->arrays[PARTITION_TYPENAMES]->len,
+			partition->arrays[PARTITION_GLOBAL_TAGS]->len,
+			partition->arrays[PARTITION_GLOBAL_TYPENAMES]->len);
+	}
 }
 #endif /* TM_DEBUG */
 
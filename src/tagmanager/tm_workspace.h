@@ -50,7 +50,7 @@ const TMWorkspace *tm_get_workspace(void);
 gboolean tm_workspace_load_global_tags(const char *tags_file, TMParserType mode);
 
 gboolean tm_workspace_create_global_tags(const char *pre_process, const char **includes,
-	int includes_count, const char *tags_file, TMParserType lang);
+	int includes_count, const char *tags_file, TMParserType lang, gboolean text);
 
 GPtrArray *tm_workspace_find(const char *name, const char *scope, TMTagType type,
 	TMTagAttrType *attrs, TMParserType lang);
@@ -60,11 +60,15 @@ GPtrArray *tm_workspace_find_prefix(const char *prefix, TMParserType lang, guint
 GPtrArray *tm_workspace_find_scope_members (TMSourceFile *source_file, const char *name,
 	gboolean function, gboolean member, const gchar *current_scope, gboolean search_namespace);
 
+const GPtrArray *tm_workspace_get_typenames(TMParserType lang, gboolean global);
+
+guint tm_workspace_get_typename_serial(TMParserType lang);
+
 
 void tm_workspace_add_source_file_noupdate(TMSourceFile *source_file);
 
-void tm_workspace_update_source_file_buffer(TMSourceFile *source_file, guchar* text_buf,
-	gsize buf_size);
+gboolean tm_workspace_update_source_file_buffer(TMSourceFile *source_file, guchar* text_buf,
+	gsize buf_size, guchar *tail_buf, gsize tail_size);
 
 void tm_workspace_free(void);
 
@@ -21,5 +21,5 @@ result="$1"
 source="${result%.*}"
 tagfile="$TMPDIR/test.${source##*.}.tags"
 
-"$GEANY" -c "$CONFDIR" -P -g "$tagfile" "$source" || exit 1
+"$GEANY" -c "$CONFDIR" -P -g --text-tags "$tagfile" "$source" || exit 1
 diff -u "$result" "$tagfile" || exit 2
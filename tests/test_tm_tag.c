@@ -0,0 +1,86 @@
+/*
+ *      test_tm_tag.c - this file is part of Geany, a fast and lightweight IDE
+ *
+ *      Copyright 2017 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "tm_tag.h"
+
+#include <string.h>
+#include <glib.h>
+
+
+static void test_intern_string(void)
+{
+	gchar *a, *b, *c;
+
+	g_assert(tm_tag_intern_string(NULL) == NULL);
+	tm_tag_release_string(NULL);
+
+	a = tm_tag_intern_string("name");
+	b = tm_tag_intern_string("name");
+	c = tm_tag_intern_string("other");
+	g_assert(a == b);
+	g_assert(a != c);
+	g_assert_cmpstr(a, ==, "name");
+	g_assert_cmpstr(c, ==, "other");
+
+	/* dropping one of two references keeps the string */
+	tm_tag_release_string(b);
+	g_assert_cmpstr(a, ==, "name");
+	b = tm_tag_intern_string("name");
+	g_assert(a == b);
+	tm_tag_release_string(b);
+
+	tm_tag_release_string(a);
+	tm_tag_release_string(c);
+
+	/* the string can be interned again after its last reference was released */
+	a = tm_tag_intern_string("name");
+	g_assert_cmpstr(a, ==, "name");
+	tm_tag_release_string(a);
+}
+
+
+static void test_release_not_interned(void)
+{
+	gchar *a = tm_tag_intern_string("scope");
+	gchar *b = tm_tag_intern_string("scope");
+	gchar *c;
+
+	/* an equal string which wasn't interned is freed without touching the
+	 * references of the interned copy */
+	tm_tag_release_string(g_strdup("scope"));
+	tm_tag_release_string(b);
+	g_assert_cmpstr(a, ==, "scope");
+
+	c = tm_tag_intern_string("scope");
+	g_assert(a == c);
+	tm_tag_release_string(c);
+	tm_tag_release_string(a);
+}
+
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/tm_tag/intern_string", test_intern_string);
+	g_test_add_func("/tm_tag/release_not_interned", test_release_not_interned);
+
+	return g_test_run();
+}